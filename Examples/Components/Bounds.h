@@ -1,175 +1,84 @@
 #pragma once
 
 #include <ECS.h>
+#include <ECSSoAManager.h>
 #include "../Utils.h"
 
-class Bounds : public ComponentManager
+struct BoundsCenter : SoAField<vec3> { static inline vec3 Default() { return vec3(0.0f); } };
+struct BoundsExtents : SoAField<vec3> { static inline vec3 Default() { return vec3(0.0f); } };
+
+class Bounds : public SoAComponentManager<BoundsCenter, BoundsExtents>
 {
 public:
 
-  class Component : public ComponentBase<Bounds>
+  class Component : public SoAComponent<Bounds>
   {
   public:
-    inline vec3& GetCenter() { return m_manager->m_centers[m_index]; }
-    inline void SetCenter(const vec3& i_newData) { m_manager->m_centers[m_index] = i_newData; }
+    inline vec3& GetCenter() { return Get<BoundsCenter>(); }
+    inline void SetCenter(const vec3& i_newData) { Get<BoundsCenter>() = i_newData; }
 
-    inline vec3& GetExtents() { return m_manager->m_extents[m_index]; }
-    inline void SetExtents(const vec3& i_newData) { m_manager->m_extents[m_index] = i_newData; }
+    inline vec3& GetExtents() { return Get<BoundsExtents>(); }
+    inline void SetExtents(const vec3& i_newData) { Get<BoundsExtents>() = i_newData; }
   };
 
-  inline void OnComponentAdd(EntityID i_entity, uint16_t i_index)
-  {
-    m_centers.insert(m_centers.begin() + i_index, vec3(0.0f));
-    m_extents.insert(m_extents.begin() + i_index, vec3(0.0f));
-  }
-
-  void OnComponentRemove(EntityID i_entity, uint16_t i_index) override
-  {
-    m_centers.erase(m_centers.begin() + i_index);
-    m_extents.erase(m_extents.begin() + i_index);
-  }
-
-  inline void ReserveComponent(uint16_t i_count)
-  {
-    m_centers.reserve(i_count);
-    m_extents.reserve(i_count);
-  }
-
-  std::vector<vec3> m_centers; //!< The centers
-  std::vector<vec3> m_extents; //!< The extents
-
 };
 
 
-class WorldBounds : public ComponentManager
+class WorldBounds : public SoAComponentManager<BoundsCenter, BoundsExtents>
 {
 public:
 
-  class Component : public ComponentBase<WorldBounds>
+  class Component : public SoAComponent<WorldBounds>
   {
   public:
-    inline vec3& GetCenter() { return m_manager->m_centers[m_index]; }
-    inline void SetCenter(const vec3& i_newData) { m_manager->m_centers[m_index] = i_newData; }
+    inline vec3& GetCenter() { return Get<BoundsCenter>(); }
+    inline void SetCenter(const vec3& i_newData) { Get<BoundsCenter>() = i_newData; }
 
-    inline vec3& GetExtents() { return m_manager->m_extents[m_index]; }
-    inline void SetExtents(const vec3& i_newData) { m_manager->m_extents[m_index] = i_newData; }
+    inline vec3& GetExtents() { return Get<BoundsExtents>(); }
+    inline void SetExtents(const vec3& i_newData) { Get<BoundsExtents>() = i_newData; }
   };
 
-  inline void OnComponentAdd(EntityID i_entity, uint16_t i_index)
-  {
-    m_centers.insert(m_centers.begin() + i_index, vec3(0.0f));
-    m_extents.insert(m_extents.begin() + i_index, vec3(0.0f));
-  }
+};
 
-  void OnComponentRemove(EntityID i_entity, uint16_t i_index) override
-  {
-    m_centers.erase(m_centers.begin() + i_index);
-    m_extents.erase(m_extents.begin() + i_index);
-  }
+// Float lanes aligned and padded to 4 so SSE loops over each array need no scalar remainder
+struct CenterX : SoALaneField<4> {};
+struct CenterY : SoALaneField<4> {};
+struct CenterZ : SoALaneField<4> {};
+struct ExtentX : SoALaneField<4> {};
+struct ExtentY : SoALaneField<4> {};
+struct ExtentZ : SoALaneField<4> {};
+
+class BoundsSIMD : public SoAComponentManager<CenterX, CenterY, CenterZ, ExtentX, ExtentY, ExtentZ>
+{
+public:
 
-  inline void ReserveComponent(uint16_t i_count)
+  class Component : public SoAComponent<BoundsSIMD>
   {
-    m_centers.reserve(i_count);
-    m_extents.reserve(i_count);
-  }
+  public:
+    inline vec3 GetCenter()
+    {
+      return vec3(Get<CenterX>(), Get<CenterY>(), Get<CenterZ>());
+    }
+
+    inline void SetCenter(const vec3& i_newData)
+    {
+      Get<CenterX>() = i_newData.x;
+      Get<CenterY>() = i_newData.y;
+      Get<CenterZ>() = i_newData.z;
+    }
+
+    inline vec3 GetExtents()
+    {
+      return vec3(Get<ExtentX>(), Get<ExtentY>(), Get<ExtentZ>());
+    }
+
+    inline void SetExtents(const vec3& i_newData)
+    {
+      Get<ExtentX>() = i_newData.x;
+      Get<ExtentY>() = i_newData.y;
+      Get<ExtentZ>() = i_newData.z;
+    }
 
-  std::vector<vec3> m_centers; //!< The centers
-  std::vector<vec3> m_extents; //!< The extents
+  };
 
 };
-
-//class BoundsSIMD : public ComponentManager
-//{
-//public:
-//
-//  class Component : public ComponentBase<BoundsSIMD>
-//  {
-//  public:
-//    inline vec3 GetCenter()
-//    {
-//      return vec3(m_manager->m_centerX[m_index],
-//                  m_manager->m_centerY[m_index],
-//                  m_manager->m_centerZ[m_index]);
-//    }
-//
-//    inline void SetCenter(const vec3& i_newData)
-//    {
-//      m_manager->m_centerX[m_index] = i_newData.x;
-//      m_manager->m_centerY[m_index] = i_newData.y;
-//      m_manager->m_centerZ[m_index] = i_newData.z;
-//    }
-//
-//    inline vec3 GetExtents()
-//    {
-//      return vec3(m_manager->m_extentX[m_index],
-//                  m_manager->m_extentY[m_index],
-//                  m_manager->m_extentZ[m_index]);
-//    }
-//
-//    inline void SetExtents(const vec3& i_newData)
-//    {
-//      m_manager->m_extentX[m_index] = i_newData.x;
-//      m_manager->m_extentY[m_index] = i_newData.y;
-//      m_manager->m_extentZ[m_index] = i_newData.z;
-//    }
-//
-//  };
-//
-//  BoundsSIMD()
-//  {
-//    // Add padding to the end of the storage arrays
-//    for (uint32_t i = 0; i < 3; i++)
-//    {
-//      m_centerX.push_back(0.0f);
-//      m_centerY.push_back(0.0f);
-//      m_centerZ.push_back(0.0f);
-//
-//      m_extentX.push_back(0.0f);
-//      m_extentY.push_back(0.0f);
-//      m_extentZ.push_back(0.0f);
-//    }
-//  }
-//
-//  inline void OnComponentAdd(EntityID i_entity, uint16_t i_index)
-//  {
-//    m_centerX.insert(m_centerX.begin() + i_index, 0.0f);
-//    m_centerY.insert(m_centerY.begin() + i_index, 0.0f);
-//    m_centerZ.insert(m_centerZ.begin() + i_index, 0.0f);
-//
-//    m_extentX.insert(m_extentX.begin() + i_index, 0.0f);
-//    m_extentY.insert(m_extentY.begin() + i_index, 0.0f);
-//    m_extentZ.insert(m_extentZ.begin() + i_index, 0.0f);
-//  }
-//
-//  void OnComponentRemove(EntityID i_entity, uint16_t i_index) override
-//  {
-//    m_centerX.erase(m_centerX.begin() + i_index);
-//    m_centerY.erase(m_centerY.begin() + i_index);
-//    m_centerZ.erase(m_centerZ.begin() + i_index);
-//
-//    m_extentX.erase(m_extentX.begin() + i_index);
-//    m_extentY.erase(m_extentY.begin() + i_index);
-//    m_extentZ.erase(m_extentZ.begin() + i_index);
-//  }
-//
-//  inline void ReserveComponent(uint16_t i_count)
-//  {
-//    m_centerX.reserve(i_count + 3);
-//    m_centerY.reserve(i_count + 3);
-//    m_centerZ.reserve(i_count + 3);
-//
-//    m_extentX.reserve(i_count + 3);
-//    m_extentY.reserve(i_count + 3);
-//    m_extentZ.reserve(i_count + 3);
-//  }
-//
-//  std::vector<float> m_centerX; //!< The center X
-//  std::vector<float> m_centerY; //!< The center Y
-//  std::vector<float> m_centerZ; //!< The center Z
-//
-//  std::vector<float> m_extentX; //!< The extents X
-//  std::vector<float> m_extentY; //!< The extents Y
-//  std::vector<float> m_extentZ; //!< The extents Z
-//
-//};
-
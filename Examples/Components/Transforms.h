@@ -1,108 +1,77 @@
 #pragma once
 
 #include <ECS.h>
+#include <ECSSoAManager.h>
 #include "../Utils.h"
 
-class Transforms : public ComponentManager
+/// \brief The parent/child links of a transform
+struct ParentChildLink
+{
+  EntityID m_parent;
+  EntityID m_child;
+};
+
+struct TransformPosition : SoAField<vec3> { static inline vec3 Default() { return vec3(0.0f); } };
+struct TransformRotation : SoAField<quat> { static inline quat Default() { return quat(1.0f, 0.0f, 0.0f, 0.0f); } };
+struct TransformScale : SoAField<vec3> { static inline vec3 Default() { return vec3(1.0f); } };
+struct TransformParentChild : SoAField<ParentChildLink> { static inline ParentChildLink Default() { return ParentChildLink{ EntityID_None, EntityID_None }; } };
+struct TransformSibling : SoAField<EntityID> { static inline EntityID Default() { return EntityID_None; } }; //!< Only points to next sibling - siblings are sorted by entity IDs
+
+class Transforms : public SoAComponentManager<TransformPosition, TransformRotation, TransformScale, TransformParentChild, TransformSibling>
 {
 public:
 
-  struct ParentChild
-  {
-    EntityID m_parent;
-    EntityID m_child;
-  };
+  typedef ParentChildLink ParentChild;
 
-  class Component : public ComponentBase<Transforms>
+  class Component : public SoAComponent<Transforms>
   {
   public:
 
-    inline vec3& GetPosition() { return m_manager->m_positions[m_index]; }
-    inline quat& GetRotation() { return m_manager->m_rotations[m_index]; }
-    inline vec3& GetScale() { return m_manager->m_scales[m_index]; }
+    inline vec3& GetPosition() { return Get<TransformPosition>(); }
+    inline quat& GetRotation() { return Get<TransformRotation>(); }
+    inline vec3& GetScale() { return Get<TransformScale>(); }
 
-    inline EntityID& GetParent() { return m_manager->m_parentChilds[m_index].m_parent; }
-    inline EntityID& GetChild() { return m_manager->m_parentChilds[m_index].m_child; }
-    inline EntityID& GetSibling() { return m_manager->m_siblings[m_index]; }
+    inline EntityID& GetParent() { return Get<TransformParentChild>().m_parent; }
+    inline EntityID& GetChild() { return Get<TransformParentChild>().m_child; }
+    inline EntityID& GetSibling() { return Get<TransformSibling>(); }
   };
 
-  inline void OnComponentAdd(EntityID i_entity, uint16_t i_index)
-  {
-    m_positions.insert(m_positions.begin() + i_index, vec3(0.0f));
-    m_rotations.insert(m_rotations.begin() + i_index, quat(1.0f, 0.0f, 0.0f, 0.0f));
-    m_scales.insert(m_scales.begin() + i_index, vec3(1.0f));
-
-    m_parentChilds.insert(m_parentChilds.begin() + i_index, ParentChild{ EntityID_None, EntityID_None });
-    m_siblings.insert(m_siblings.begin() + i_index, EntityID_None);
-  }
-
-  void OnComponentRemove(EntityID i_entity, uint16_t i_index) override
+  void OnComponentRemove(EntityID i_entity, ECSIndex i_index) override
   {
-    AT_ASSERT(m_parentChilds[i_index].m_parent == EntityID_None);
-    AT_ASSERT(m_parentChilds[i_index].m_child == EntityID_None);
-    AT_ASSERT(m_siblings[i_index] == EntityID_None);
-
-    m_positions.erase(m_positions.begin() + i_index);
-    m_rotations.erase(m_rotations.begin() + i_index);
-    m_scales.erase(m_scales.begin() + i_index);
+    AT_ASSERT(GetArray<TransformParentChild>()[i_index].m_parent == EntityID_None);
+    AT_ASSERT(GetArray<TransformParentChild>()[i_index].m_child == EntityID_None);
+    AT_ASSERT(GetArray<TransformSibling>()[i_index] == EntityID_None);
 
-    m_parentChilds.erase(m_parentChilds.begin() + i_index);
-    m_siblings.erase(m_siblings.begin() + i_index);
+    SoAComponentManager::OnComponentRemove(i_entity, i_index);
   }
 
-  inline void ReserveComponent(uint16_t i_count)
+  void OnComponentsRemove(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count) override
   {
-    m_positions.reserve(i_count);
-    m_rotations.reserve(i_count);
-    m_scales.reserve(i_count);
-
-    m_parentChilds.reserve(i_count);
-    m_siblings.reserve(i_count);
+    for (ECSIndex i = 0; i < i_count; i++)
+    {
+      AT_ASSERT(GetArray<TransformParentChild>()[i_indices[i]].m_parent == EntityID_None);
+      AT_ASSERT(GetArray<TransformParentChild>()[i_indices[i]].m_child == EntityID_None);
+      AT_ASSERT(GetArray<TransformSibling>()[i_indices[i]] == EntityID_None);
+    }
+
+    SoAComponentManager::OnComponentsRemove(i_entities, i_indices, i_count);
   }
-
-  std::vector<vec3> m_positions; //!< The positions
-  std::vector<quat> m_rotations; //!< The rotations
-  std::vector<vec3> m_scales;    //!< The scales
-
-  std::vector<ParentChild> m_parentChilds; //!< The parent/child relationship arrays
-  std::vector<EntityID>    m_siblings;     //!< The array of siblings (only points to next sibling - siblings are sorted by entity IDs)
 };
 
 
-class WorldTransforms : public ComponentManager
+struct WorldTransform : SoAField<mat4x3> { static inline mat4x3 Default() { return mat4x3(1.0f); } }; //!< The world transform without scale
+struct WorldScale : SoAField<vec3> { static inline vec3 Default() { return vec3(1.0f); } };
+
+class WorldTransforms : public SoAComponentManager<WorldTransform, WorldScale>
 {
 public:
 
-  class Component : public ComponentBase<WorldTransforms>
+  class Component : public SoAComponent<WorldTransforms>
   {
   public:
 
-    inline vec3&   GetWorldPosition() { return m_manager->m_worldTransform[m_index][3]; }
-    inline mat4x3& GetWorldTransform() { return m_manager->m_worldTransform[m_index]; }
-    inline vec3&   GetWorldScale() { return m_manager->m_worldScales[m_index]; }
+    inline vec3&   GetWorldPosition() { return Get<WorldTransform>()[3]; }
+    inline mat4x3& GetWorldTransform() { return Get<WorldTransform>(); }
+    inline vec3&   GetWorldScale() { return Get<WorldScale>(); }
   };
-
-  inline void OnComponentAdd(EntityID i_entity, uint16_t i_index)
-  {
-    m_worldTransform.insert(m_worldTransform.begin() + i_index, mat4x3(1.0f));
-    m_worldScales.insert(m_worldScales.begin() + i_index, vec3(1.0f));
-  }
-
-  void OnComponentRemove(EntityID i_entity, uint16_t i_index) override
-  {
-    m_worldTransform.erase(m_worldTransform.begin() + i_index);
-    m_worldScales.erase(m_worldScales.begin() + i_index);
-  }
-
-  inline void ReserveComponent(uint16_t i_count)
-  {
-    m_worldTransform.reserve(i_count);
-    m_worldScales.reserve(i_count);
-  }
-
-  std::vector<mat4x3> m_worldTransform; //!< The world transform without scale
-  std::vector<vec3>   m_worldScales;    //!< The world scales
 };
-
-
-
@@ -26,13 +26,37 @@ void GameContext::RemoveEntity(EntityID i_entity)
   Context<GameGroup>::RemoveEntity(i_entity);
 }
 
+void GameContext::RemoveEntities(const EntityID* i_entities, uint32_t i_count)
+{
+  // Unhook all transforms, adding child entities to the array to delete
+  std::vector<EntityID> entities(i_entities, i_entities + i_count);
+  for (uint32_t i = 0; i < entities.size(); i++)
+  {
+    EntityID entity = entities[i];
+    AT_ASSERT(IsValid(entity));
+    if (HasComponent<Transforms>(entity))
+    {
+      SetParent_NoUpdate(*this, entity, EntityID_None);
+
+      EntityID childID = GetComponent<Transforms>(entity).GetChild();
+      while (childID != EntityID_None)
+      {
+        entities.push_back(childID);
+        childID = GetComponent<Transforms>(childID).GetSibling();
+      }
+    }
+  }
+
+  Context<GameGroup>::RemoveEntities(entities.data(), (uint32_t)entities.size());
+}
+
 void GameContext::RemoveEntityGroup(GroupID i_group)
 {
   AT_ASSERT(IsValid(i_group));
 
   // Unhook all transforms
-  Transforms& transforms = GetManager<Transforms>(*m_groups[(uint16_t)i_group]);
-  for (Transforms::ParentChild& parentChild : transforms.m_parentChilds)
+  Transforms& transforms = GetManager<Transforms>(*m_groups[(ECSIndex)i_group]);
+  for (Transforms::ParentChild& parentChild : transforms.GetArray<TransformParentChild>())
   {
     // If the parent is not of this group - un-hook all children to be deleted
     if (parentChild.m_parent != EntityID_None &&
@@ -14,6 +14,12 @@ public:
   /// \param i_entity The entity to delete
   void RemoveEntity(EntityID i_entity) override;
 
+  /// \brief Overridden removal of multiple entities. Does component specific delete operations.
+  ///        NOTE: This will also recursively delete child entities. 
+  /// \param i_entities The entities to delete
+  /// \param i_count The count of entities
+  void RemoveEntities(const EntityID* i_entities, uint32_t i_count) override;
+
   /// \brief Overridden removal of a group. Does component specific delete operations.
   ///        NOTE: This also deletes entities that are children of entities in this group. To optimize, always delete child groups first if possible.
   /// \param The group to delete. 
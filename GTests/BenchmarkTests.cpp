@@ -0,0 +1,1097 @@
+#define GTEST_HAS_TR1_TUPLE 0
+#include "gtest/gtest.h"
+
+#include "../Examples/GameContext.h"
+#include "../Examples/Components/Transforms.h"
+#include "../Examples/Components/Bounds.h"
+
+#include <ECS.h>
+#include <ECSIter.h>
+#include <ECSParallel.h>
+#include <ECSQuery.h>
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+  /// \brief Simple timer used to report benchmark timings
+  class BenchTimer
+  {
+  public:
+
+    inline BenchTimer() : m_start(std::chrono::high_resolution_clock::now()) {}
+
+    /// \brief Get the elapsed time in milliseconds since the timer was created
+    inline double GetMS() const
+    {
+      return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_start).count();
+    }
+
+  private:
+    std::chrono::high_resolution_clock::time_point m_start; //!< The start time
+  };
+
+  /// \brief Deterministic random number generator so benchmark runs are repeatable
+  class BenchRandom
+  {
+  public:
+
+    inline uint32_t Next()
+    {
+      m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+      return uint32_t(m_state >> 33);
+    }
+
+  private:
+    uint64_t m_state = 12345; //!< The generator state
+  };
+
+  /// \brief A component manager that stores no data, to benchmark only the bit array and prefix sum costs
+  class EmptyManager : public ComponentManager
+  {
+  public:
+    class Component : public ComponentBase<EmptyManager> {};
+
+    inline void OnComponentAdd(EntityID i_entity, ECSIndex i_index) {}
+    inline void OnComponentsAdd(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count) {}
+    void OnComponentRemove(EntityID i_entity, ECSIndex i_index) override {}
+  };
+
+  /// \brief A second data-less component manager, used as an iteration filter
+  class EmptyFlagManager : public ComponentManager
+  {
+  public:
+    class Component : public ComponentBase<EmptyFlagManager> {};
+
+    inline void OnComponentAdd(EntityID i_entity, ECSIndex i_index) {}
+    inline void OnComponentsAdd(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count) {}
+    void OnComponentRemove(EntityID i_entity, ECSIndex i_index) override {}
+  };
+
+  /// \brief Flags used as additional iteration filters
+  template<int N>
+  class BenchFilter : public FlagManager {};
+
+  class BenchGroup : public EntityGroup
+  {
+  public:
+    BenchGroup()
+    {
+      AddManager(&m_emptyManager);
+      AddManager(&m_emptyFlagManager);
+      AddManager(&m_filter1);
+      AddManager(&m_filter2);
+      AddManager(&m_filter3);
+      AddManager(&m_filter4);
+    }
+
+    EmptyManager m_emptyManager;
+    EmptyFlagManager m_emptyFlagManager;
+    BenchFilter<1> m_filter1;
+    BenchFilter<2> m_filter2;
+    BenchFilter<3> m_filter3;
+    BenchFilter<4> m_filter4;
+  };
+
+  /// \brief The previous flat prefix sum implementation - each bit change updates every following prefix sum
+  class FlatPrefixSum
+  {
+  public:
+
+    inline FlatPrefixSum(uint32_t i_entityCount)
+    {
+      m_bitData.resize((i_entityCount + 63) >> 6, 0);
+      m_prevSum.resize((i_entityCount + 63) >> 6, 0);
+    }
+
+    inline bool HasBit(uint16_t i_entitySubID) const
+    {
+      return (m_bitData[i_entitySubID >> 6] & (uint64_t(1) << (i_entitySubID & 0x3F))) != 0;
+    }
+
+    inline uint16_t SetBit(uint16_t i_entitySubID)
+    {
+      uint64_t mask = uint64_t(1) << (i_entitySubID & 0x3F);
+      uint16_t index = i_entitySubID >> 6;
+
+      uint16_t offset = m_prevSum[index] + PopCount64(m_bitData[index] & (mask - 1));
+      m_bitData[index] |= mask;
+      for (uint32_t i = uint32_t(index) + 1; i < m_prevSum.size(); i++)
+      {
+        m_prevSum[i]++;
+      }
+      return offset;
+    }
+
+    inline uint16_t ClearBit(uint16_t i_entitySubID)
+    {
+      uint64_t mask = uint64_t(1) << (i_entitySubID & 0x3F);
+      uint16_t index = i_entitySubID >> 6;
+
+      uint16_t offset = m_prevSum[index] + PopCount64(m_bitData[index] & (mask - 1));
+      m_bitData[index] &= ~mask;
+      for (uint32_t i = uint32_t(index) + 1; i < m_prevSum.size(); i++)
+      {
+        m_prevSum[i]--;
+      }
+      return offset;
+    }
+
+    inline uint16_t GetComponentIndex(uint16_t i_entitySubID) const
+    {
+      uint64_t mask = uint64_t(1) << (i_entitySubID & 0x3F);
+      uint16_t index = i_entitySubID >> 6;
+      return m_prevSum[index] + PopCount64(m_bitData[index] & (mask - 1));
+    }
+
+    std::vector<uint64_t> m_bitData; //!< The array of bit data
+    std::vector<uint16_t> m_prevSum; //!< The sum of all previous bits in the bit array
+  };
+
+  /// \brief The previous iteration implementation - shifts through every bit of the bit array one at a time
+  /// \param i_bits The component bits to iterate
+  /// \param i_flagBits The filter bits that must also be set (or nullptr for no filter)
+  /// \return The sum of the visited entity sub ids and component indices
+  inline uint32_t PerBitIterationSum(const std::vector<uint64_t>& i_bits, const std::vector<uint64_t>* i_flagBits)
+  {
+    uint32_t sum = 0;
+    uint16_t index = 0;
+    uint32_t entitySubID = 0;
+    for (uint32_t i = 0; i < i_bits.size(); i++)
+    {
+      uint64_t bits = i_bits[i];
+      uint64_t flagBits = (i_flagBits != nullptr) ? (*i_flagBits)[i] : UINT64_MAX;
+      for (uint64_t testBit = 0x1; testBit != 0; testBit <<= 1, entitySubID++)
+      {
+        if ((bits & testBit) != 0)
+        {
+          if ((flagBits & testBit) != 0)
+          {
+            sum += entitySubID + index;
+          }
+          index++;
+        }
+      }
+    }
+    return sum;
+  }
+
+  /// \brief The previous filtered group iterator - ANDs one bit data item of each filter at a time
+  template <class T, class E, typename... Args>
+  class PerItemFilterProcess
+  {
+  public:
+
+    inline PerItemFilterProcess(GroupID i_groupID, E &i_group) : m_groupID(i_groupID), m_group(i_group) {}
+
+    struct Value : public T::Component
+    {
+    protected:
+
+      ECSIndex m_groupIndex = 0;
+      ECSIndex m_entitySubID = 0;
+
+    public:
+
+      inline EntityID GetEntityID() const
+      {
+        return EntityID{ (GroupID)m_groupIndex, (EntitySubID)m_entitySubID };
+      }
+    };
+
+    struct Iterator : public Value
+    {
+      using Value::m_index;
+      using Value::m_manager;
+      using Value::m_groupIndex;
+      using Value::m_entitySubID;
+
+      ECSIndex m_componentCount = 0;
+      uint64_t m_bits = 0;      //!< The component bits of the current bit data item
+      uint64_t m_flagBits = 0;  //!< The remaining filtered bits of the current bit data item (current entity is the lowest bit)
+      E&       m_group;
+
+      inline Iterator(GroupID i_groupID, E &i_group)
+      : m_group(i_group)
+      {
+        m_groupIndex = (ECSIndex)i_groupID;
+        m_manager = &::GetManager<T>(m_group);
+        m_componentCount = m_manager->GetComponentCount();
+
+        m_index = m_componentCount; // Set initial index in case no values found
+        if (m_componentCount > 0 &&
+            FindBits(0))
+        {
+          UpdateEntityID();
+        }
+      }
+
+      template<typename H>
+      inline uint64_t GetFlagBits(ECSIndex i_index) const
+      {
+        return GetManager<H>(m_group).GetBits()[i_index];
+      }
+
+      template<typename H, typename... Tail, typename = typename std::enable_if<(sizeof...(Tail)) != 0>::type>
+      inline uint64_t GetFlagBits(ECSIndex i_index) const
+      {
+        return GetFlagBits<H>(i_index) &
+               GetFlagBits<Tail...>(i_index);
+      }
+
+      inline Iterator& operator++()
+      {
+        // Clear the current bit and jump to the next set bit, ending if no more entities
+        m_flagBits &= m_flagBits - 1;
+        if (m_flagBits != 0 ||
+            FindBits(uint32_t(m_entitySubID >> 6) + 1))
+        {
+          UpdateEntityID();
+        }
+        else
+        {
+          m_index = m_componentCount;
+        }
+
+        return *this;
+      }
+
+      inline bool FindBits(uint32_t i_start)
+      {
+        // Skip long runs of 0 bits using the summary bitmap
+        const std::vector<uint64_t>& bits = m_manager->GetBits();
+        for (uint32_t i = m_manager->FindNextBits(i_start); i < bits.size(); i = m_manager->FindNextBits(i + 1))
+        {
+          uint64_t flagBits = bits[i] & GetFlagBits<Args...>((ECSIndex)i);
+          if (flagBits != 0)
+          {
+            m_bits = bits[i];
+            m_flagBits = flagBits;
+            m_entitySubID = ECSIndex(i << 6);
+            return true;
+          }
+        }
+        return false;
+      }
+
+      inline void UpdateEntityID()
+      {
+        uint32_t bitIndex = CountTrailingZeros64(m_flagBits);
+        uint32_t index = uint32_t(m_entitySubID >> 6);
+        m_entitySubID = ECSIndex((index << 6) + bitIndex);
+        m_index = T::c_unordered ? m_manager->GetDataIndex((EntitySubID)m_entitySubID) :
+                                   m_manager->GetPrevSum(index) + PopCount64(m_bits & ((uint64_t(1) << bitIndex) - 1));
+      }
+
+      inline bool operator != (ECSIndex) const { return this->m_index < this->m_componentCount; }
+      inline Value& operator *() { return *this; }
+    };
+
+    inline Iterator begin() { return Iterator(m_groupID, m_group); }
+    inline ECSIndex end() { return 0; }
+
+    GroupID m_groupID;
+    E& m_group;
+  };
+}
+template<> inline EmptyManager& GetManager<EmptyManager>(BenchGroup& i_group) { return i_group.m_emptyManager; }
+template<> inline EmptyFlagManager& GetManager<EmptyFlagManager>(BenchGroup& i_group) { return i_group.m_emptyFlagManager; }
+template<> inline BenchFilter<1>& GetManager<BenchFilter<1>>(BenchGroup& i_group) { return i_group.m_filter1; }
+template<> inline BenchFilter<2>& GetManager<BenchFilter<2>>(BenchGroup& i_group) { return i_group.m_filter2; }
+template<> inline BenchFilter<3>& GetManager<BenchFilter<3>>(BenchGroup& i_group) { return i_group.m_filter3; }
+template<> inline BenchFilter<4>& GetManager<BenchFilter<4>>(BenchGroup& i_group) { return i_group.m_filter4; }
+
+TEST(BenchmarkTests, PrefixSum)
+{
+  const uint32_t c_entityCount = UINT16_MAX;
+  const uint32_t c_opCount = 100000;
+
+  // Benchmark the flat prefix sum
+  uint32_t flatCheckSum = 0;
+  double flatUpdateMS = 0.0;
+  double flatLookupMS = 0.0;
+  {
+    FlatPrefixSum flat(c_entityCount);
+    BenchRandom random;
+    {
+      BenchTimer timer;
+      for (uint32_t i = 0; i < c_opCount; i++)
+      {
+        uint16_t id = uint16_t(random.Next() % c_entityCount);
+        flatCheckSum += flat.HasBit(id) ? flat.ClearBit(id) : flat.SetBit(id);
+      }
+      flatUpdateMS = timer.GetMS();
+    }
+    {
+      BenchTimer timer;
+      for (uint32_t i = 0; i < c_opCount; i++)
+      {
+        flatCheckSum += flat.GetComponentIndex(uint16_t(random.Next() % c_entityCount));
+      }
+      flatLookupMS = timer.GetMS();
+    }
+  }
+
+  // Benchmark the context using the block prefix sum
+  uint32_t checkSum = 0;
+  double updateMS = 0.0;
+  double lookupMS = 0.0;
+  {
+    Context<BenchGroup> context;
+    GroupID group = context.AddEntityGroup();
+    context.ReserveEntities(group, c_entityCount);
+    for (uint32_t i = 0; i < c_entityCount; i++)
+    {
+      context.AddEntity(group);
+    }
+
+    EmptyManager& manager = context.GetGroup(group)->m_emptyManager;
+    BenchRandom random;
+    {
+      BenchTimer timer;
+      for (uint32_t i = 0; i < c_opCount; i++)
+      {
+        EntityID id{ group, EntitySubID(random.Next() % c_entityCount) };
+        if (context.HasComponent<EmptyManager>(id))
+        {
+          checkSum += manager.GetComponentIndex(id.m_subID);
+          context.RemoveComponent<EmptyManager>(id);
+        }
+        else
+        {
+          checkSum += context.AddComponent<EmptyManager>(id).m_index;
+        }
+      }
+      updateMS = timer.GetMS();
+    }
+    {
+      BenchTimer timer;
+      for (uint32_t i = 0; i < c_opCount; i++)
+      {
+        checkSum += manager.GetComponentIndex(EntitySubID(random.Next() % c_entityCount));
+      }
+      lookupMS = timer.GetMS();
+    }
+  }
+
+  // Both implementations must calculate the same indices
+  EXPECT_EQ(flatCheckSum, checkSum);
+
+  printf("PrefixSum %u entities, %u ops: flat add/remove %.2fms lookup %.2fms | block add/remove %.2fms lookup %.2fms\n",
+         c_entityCount, c_opCount, flatUpdateMS, flatLookupMS, updateMS, lookupMS);
+}
+
+TEST(BenchmarkTests, BitScanIteration)
+{
+  const uint32_t c_entityCount = UINT16_MAX;
+  const uint32_t c_repeatCount = 20;
+  const uint32_t c_densities[] = { 1, 10, 50, 100 };
+
+  for (uint32_t density : c_densities)
+  {
+    Context<BenchGroup> context;
+    GroupID group = context.AddEntityGroup();
+    std::vector<EntityID> entities(c_entityCount);
+    context.AddEntities(group, ECSIndex(c_entityCount), entities.data());
+
+    // Add the components at the given percentage density, with the filter on half of the entities
+    BenchRandom random;
+    std::vector<uint64_t> mask((c_entityCount + 63) >> 6, 0);
+    std::vector<uint64_t> flagMask((c_entityCount + 63) >> 6, 0);
+    for (uint32_t i = 0; i < c_entityCount; i++)
+    {
+      if ((random.Next() % 100) < density)
+      {
+        mask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+      }
+      if ((random.Next() & 0x1) != 0)
+      {
+        flagMask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+      }
+    }
+    context.AddComponents<EmptyManager>(group, mask.data());
+    context.AddComponents<EmptyFlagManager>(group, flagMask.data());
+
+    const BenchGroup& benchGroup = *context.GetGroup(group);
+    const std::vector<uint64_t>& bits = benchGroup.m_emptyManager.GetBits();
+    const std::vector<uint64_t>& flagBits = benchGroup.m_emptyFlagManager.GetBits();
+
+    uint32_t perBitSum = 0;
+    uint32_t perBitFilterSum = 0;
+    double perBitMS = 0.0;
+    double perBitFilterMS = 0.0;
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        perBitSum += PerBitIterationSum(bits, nullptr);
+      }
+      perBitMS = timer.GetMS();
+    }
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        perBitFilterSum += PerBitIterationSum(bits, &flagBits);
+      }
+      perBitFilterMS = timer.GetMS();
+    }
+
+    uint32_t scanSum = 0;
+    uint32_t scanFilterSum = 0;
+    double scanMS = 0.0;
+    double scanFilterMS = 0.0;
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : IterEntity<EmptyManager>(context, group))
+        {
+          scanSum += (ECSIndex)i.GetEntityID().m_subID + i.m_index;
+        }
+      }
+      scanMS = timer.GetMS();
+    }
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : IterEntity<EmptyManager, EmptyFlagManager>(context, group))
+        {
+          scanFilterSum += (ECSIndex)i.GetEntityID().m_subID + i.m_index;
+        }
+      }
+      scanFilterMS = timer.GetMS();
+    }
+
+    // Both implementations must visit the same entities and indices
+    EXPECT_EQ(perBitSum, scanSum);
+    EXPECT_EQ(perBitFilterSum, scanFilterSum);
+
+    printf("BitScanIteration %u entities, %3u%% density, %u passes: per bit %.2fms filtered %.2fms | bit scan %.2fms filtered %.2fms\n",
+           c_entityCount, density, c_repeatCount, perBitMS, perBitFilterMS, scanMS, scanFilterMS);
+  }
+}
+
+TEST(BenchmarkTests, PopCount)
+{
+  const uint32_t c_valueCount = 4096;
+  const uint32_t c_repeatCount = 1000;
+
+  BenchRandom random;
+  std::vector<uint64_t> values(c_valueCount);
+  for (uint64_t& value : values)
+  {
+    value = (uint64_t(random.Next()) << 32) ^ random.Next();
+  }
+
+  uint32_t softwareSum = 0;
+  double softwareMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      for (uint64_t value : values)
+      {
+        softwareSum += PopCount64Software(value ^ r);
+      }
+    }
+    softwareMS = timer.GetMS();
+  }
+
+  uint32_t sum = 0;
+  double ms = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      for (uint64_t value : values)
+      {
+        sum += PopCount64(value ^ r);
+      }
+    }
+    ms = timer.GetMS();
+  }
+
+  EXPECT_EQ(softwareSum, sum);
+
+#if defined(AT_NATIVE_POPCOUNT)
+  const char* mode = "native";
+#else
+  const char* mode = "software";
+#endif
+  printf("PopCount %u values: software %.2fms | PopCount64 (%s) %.2fms\n", c_valueCount * c_repeatCount, softwareMS, mode, ms);
+}
+
+TEST(BenchmarkTests, GetComponent)
+{
+  const uint32_t c_entityCount = 60000;
+  const uint32_t c_lookupCount = 1000000;
+
+  GameContext context;
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(c_entityCount);
+  context.AddEntities(group, ECSIndex(c_entityCount), entities.data());
+
+  // Add transforms to every second entity, so lookups are spread over partially filled bit data
+  std::vector<uint64_t> mask((c_entityCount + 63) >> 6, 0);
+  for (uint32_t i = 0; i < c_entityCount; i += 2)
+  {
+    mask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+  }
+  context.AddComponents<Transforms>(group, mask.data());
+  for (auto& i : IterEntity<Transforms>(context, group))
+  {
+    i.GetPosition() = vec3(float(i.GetEntityID().m_subID));
+  }
+
+  // Look up random entities with transforms
+  BenchRandom random;
+  float sum = 0.0f;
+  double ms = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t i = 0; i < c_lookupCount; i++)
+    {
+      EntityID entity = entities[(random.Next() % (c_entityCount / 2)) * 2];
+      sum += context.GetComponent<Transforms>(entity).GetPosition().x;
+    }
+    ms = timer.GetMS();
+  }
+  EXPECT_GT(sum, 0.0f);
+
+  printf("GetComponent %u random lookups over %u entities: %.2fms (%.1f M lookups/s)\n",
+         c_lookupCount, c_entityCount, ms, (c_lookupCount / 1000.0) / ms);
+}
+
+TEST(BenchmarkTests, ParallelForEach)
+{
+  const uint32_t c_groupCount = 8;
+  const uint32_t c_entityCount = 16384;
+  const uint32_t c_repeatCount = 20;
+
+  GameContext context;
+  for (uint32_t g = 0; g < c_groupCount; g++)
+  {
+    GroupID group = context.AddEntityGroup();
+    std::vector<EntityID> entities(c_entityCount);
+    context.AddEntities(group, ECSIndex(c_entityCount), entities.data());
+    context.AddComponents<Transforms>(group, entities[0].m_subID, ECSIndex(c_entityCount));
+  }
+
+  // Rotate each position a little each pass
+  const quat rotation = angleAxis(0.01f, vec3(0.0f, 1.0f, 0.0f));
+  auto update = [&rotation](auto& i)
+  {
+    i.GetRotation() = normalize(rotation * i.GetRotation());
+    i.GetPosition() = i.GetRotation() * (i.GetPosition() + vec3(1.0f));
+  };
+
+  double serialMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      for (auto& i : IterEntity<Transforms>(context))
+      {
+        update(i);
+      }
+    }
+    serialMS = timer.GetMS();
+  }
+
+  TaskPool& pool = TaskPool::GetDefault();
+  double parallelMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      ParallelForEach<Transforms>(pool, context, update);
+    }
+    parallelMS = timer.GetMS();
+  }
+
+  printf("ParallelForEach %u entities, %u passes: IterEntity %.2fms | ParallelForEach (%u threads) %.2fms\n",
+         c_groupCount * c_entityCount, c_repeatCount, serialMS, pool.GetThreadCount(), parallelMS);
+}
+
+TEST(BenchmarkTests, Query)
+{
+  const uint32_t c_groupCount = 16;
+  const uint32_t c_entityCount = 16384;
+  const uint32_t c_repeatCount = 50;
+
+  // Half of the entities have the component, few have the filter (eg. a 'visible' or 'dirty' subset)
+  Context<BenchGroup> context;
+  std::vector<GroupID> groups;
+  BenchRandom random;
+  for (uint32_t g = 0; g < c_groupCount; g++)
+  {
+    GroupID group = context.AddEntityGroup();
+    groups.push_back(group);
+    std::vector<EntityID> entities(c_entityCount);
+    context.AddEntities(group, ECSIndex(c_entityCount), entities.data());
+
+    std::vector<uint64_t> mask((c_entityCount + 63) >> 6, 0);
+    std::vector<uint64_t> flagMask((c_entityCount + 63) >> 6, 0);
+    for (uint32_t i = 0; i < c_entityCount; i++)
+    {
+      if ((random.Next() & 0x1) != 0)
+      {
+        mask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+      }
+      if ((random.Next() % 100) < 2)
+      {
+        flagMask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+      }
+    }
+    context.AddComponents<EmptyManager>(group, mask.data());
+    context.AddComponents<EmptyFlagManager>(group, flagMask.data());
+  }
+
+  uint32_t iterSum = 0;
+  double iterMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      for (auto& i : IterEntity<EmptyManager, EmptyFlagManager>(context))
+      {
+        iterSum += (ECSIndex)i.GetEntityID().m_subID + i.m_index;
+      }
+    }
+    iterMS = timer.GetMS();
+  }
+
+  Query<EmptyManager, EmptyFlagManager> query;
+  uint32_t querySum = 0;
+  double queryMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      for (auto& i : query.Iter(context))
+      {
+        querySum += (ECSIndex)i.GetEntityID().m_subID + i.m_index;
+      }
+    }
+    queryMS = timer.GetMS();
+  }
+  EXPECT_EQ(iterSum, querySum);
+  EXPECT_EQ(c_groupCount, query.GetRebuildCount());
+
+  // Change one group each pass, so only that group is rebuilt
+  double changedMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      EntityID entity{ groups[r % c_groupCount], EntitySubID(r) };
+      if (context.HasComponent<EmptyFlagManager>(entity))
+      {
+        context.RemoveComponent<EmptyFlagManager>(entity);
+      }
+      else
+      {
+        context.AddComponent<EmptyFlagManager>(entity);
+      }
+
+      for (auto& i : query.Iter(context))
+      {
+        querySum += (ECSIndex)i.GetEntityID().m_subID + i.m_index;
+      }
+    }
+    changedMS = timer.GetMS();
+  }
+  EXPECT_EQ(c_groupCount + c_repeatCount, query.GetRebuildCount());
+
+  printf("Query %u entities, %u passes: IterEntity %.2fms | Query %.2fms, with one group changed per pass %.2fms\n",
+         c_groupCount * c_entityCount, c_repeatCount, iterMS, queryMS, changedMS);
+}
+
+TEST(BenchmarkTests, MultiFilterIteration)
+{
+  const uint32_t c_entityCount = UINT16_MAX;
+  const uint32_t c_repeatCount = 1000;
+  const uint32_t c_runCount = 5;
+
+  // The component on all entities, each filter on a random 1/4 of the entities (so most bit data items have no entities with all filters)
+  Context<BenchGroup> context;
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(c_entityCount);
+  context.AddEntities(group, ECSIndex(c_entityCount), entities.data());
+  context.AddComponents<EmptyManager>(group, entities[0].m_subID, ECSIndex(c_entityCount));
+
+  BenchRandom random;
+  std::vector<uint64_t> flagMask((c_entityCount + 63) >> 6, 0);
+  for (uint32_t i = 0; i < c_entityCount; i++)
+  {
+    if ((random.Next() & 0x3) == 0)
+    {
+      flagMask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+    }
+  }
+  context.AddComponents<EmptyFlagManager>(group, flagMask.data());
+  for (uint32_t i = 0; i < c_entityCount; i++)
+  {
+    context.SetFlag<BenchFilter<1>>(entities[i], (random.Next() & 0x3) == 0);
+    context.SetFlag<BenchFilter<2>>(entities[i], (random.Next() & 0x3) == 0);
+    context.SetFlag<BenchFilter<3>>(entities[i], (random.Next() & 0x3) == 0);
+    context.SetFlag<BenchFilter<4>>(entities[i], (random.Next() & 0x3) == 0);
+  }
+  BenchGroup& benchGroup = *context.GetGroup(group);
+
+  // Take the fastest of several runs of each implementation, as single runs vary by more than the difference between them
+  uint32_t wordSum = 0;
+  uint32_t wordSum5 = 0;
+  uint32_t maskSum = 0;
+  uint32_t maskSum5 = 0;
+  double wordMS = 1e9;
+  double wordMS5 = 1e9;
+  double maskMS = 1e9;
+  double maskMS5 = 1e9;
+  for (uint32_t run = 0; run < c_runCount; run++)
+  {
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : PerItemFilterProcess<EmptyManager, BenchGroup, EmptyFlagManager, BenchFilter<1>, BenchFilter<2>, BenchFilter<3>>(group, benchGroup))
+        {
+          wordSum += (ECSIndex)i.GetEntityID().m_subID + i.m_index;
+        }
+      }
+      wordMS = std::min(wordMS, timer.GetMS());
+    }
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : PerItemFilterProcess<EmptyManager, BenchGroup, EmptyFlagManager, BenchFilter<1>, BenchFilter<2>, BenchFilter<3>, BenchFilter<4>>(group, benchGroup))
+        {
+          wordSum5 += (ECSIndex)i.GetEntityID().m_subID + i.m_index;
+        }
+      }
+      wordMS5 = std::min(wordMS5, timer.GetMS());
+    }
+
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : IterEntity<EmptyManager, EmptyFlagManager, BenchFilter<1>, BenchFilter<2>, BenchFilter<3>>(context, group))
+        {
+          maskSum += (ECSIndex)i.GetEntityID().m_subID + i.m_index;
+        }
+      }
+      maskMS = std::min(maskMS, timer.GetMS());
+    }
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : IterEntity<EmptyManager, EmptyFlagManager, BenchFilter<1>, BenchFilter<2>, BenchFilter<3>, BenchFilter<4>>(context, group))
+        {
+          maskSum5 += (ECSIndex)i.GetEntityID().m_subID + i.m_index;
+        }
+      }
+      maskMS5 = std::min(maskMS5, timer.GetMS());
+    }
+  }
+
+  // Both implementations must visit the same entities and indices
+  EXPECT_EQ(wordSum, maskSum);
+  EXPECT_EQ(wordSum5, maskSum5);
+
+#if defined(AT_SIMD_BITS_AVX2)
+  const char* mode = "AVX2";
+#elif defined(AT_SIMD_BITS_SSE2)
+  const char* mode = "SSE2";
+#else
+  const char* mode = "scalar";
+#endif
+  printf("MultiFilterIteration %u entities, %u passes (best of %u): per item AND 4 filters %.2fms 5 filters %.2fms | block mask (%s) 4 filters %.2fms 5 filters %.2fms\n",
+         c_entityCount, c_repeatCount, c_runCount, wordMS, wordMS5, mode, maskMS, maskMS5);
+}
+
+TEST(BenchmarkTests, WithoutOptionalIteration)
+{
+  const uint32_t c_entityCount = UINT16_MAX;
+  const uint32_t c_repeatCount = 100;
+
+  // The component on all entities, two excluded flags and an optional component each on a random 1/4 of the entities
+  Context<BenchGroup> context;
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(c_entityCount);
+  context.AddEntities(group, ECSIndex(c_entityCount), entities.data());
+  context.AddComponents<EmptyManager>(group, entities[0].m_subID, ECSIndex(c_entityCount));
+
+  BenchRandom random;
+  std::vector<uint64_t> optionalMask((c_entityCount + 63) >> 6, 0);
+  for (uint32_t i = 0; i < c_entityCount; i++)
+  {
+    if ((random.Next() & 0x3) == 0)
+    {
+      optionalMask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+    }
+    context.SetFlag<BenchFilter<1>>(entities[i], (random.Next() & 0x3) == 0);
+    context.SetFlag<BenchFilter<2>>(entities[i], (random.Next() & 0x3) == 0);
+  }
+  context.AddComponents<EmptyFlagManager>(group, optionalMask.data());
+
+  // Testing each entity with HasFlag/HasComponent, then looking up the optional component
+  uint32_t lookupSum = 0;
+  double lookupMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      for (auto& i : IterEntity<EmptyManager>(context, group))
+      {
+        EntityID entity = i.GetEntityID();
+        if (!context.HasFlag<BenchFilter<1>>(entity) && !context.HasFlag<BenchFilter<2>>(entity))
+        {
+          lookupSum += (ECSIndex)entity.m_subID;
+          if (context.HasComponent<EmptyFlagManager>(entity))
+          {
+            lookupSum += context.GetComponent<EmptyFlagManager>(entity).m_index;
+          }
+        }
+      }
+    }
+    lookupMS = timer.GetMS();
+  }
+
+  // Without<> filters removed in the intersected mask, the optional component index from the prefix sum
+  uint32_t filterSum = 0;
+  double filterMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      for (auto& i : IterEntity<EmptyManager, Without<BenchFilter<1>>, Without<BenchFilter<2>>, Optional<EmptyFlagManager>>(context, group))
+      {
+        filterSum += (ECSIndex)i.GetEntityID().m_subID;
+        EmptyFlagManager::Component optional;
+        if (i.GetOptional<EmptyFlagManager>(optional))
+        {
+          filterSum += optional.m_index;
+        }
+      }
+    }
+    filterMS = timer.GetMS();
+  }
+
+  // Both must visit the same entities and optional components
+  EXPECT_EQ(lookupSum, filterSum);
+  printf("WithoutOptionalIteration %u entities, %u passes: per entity HasFlag/GetComponent %.2fms | Without/Optional filters %.2fms\n",
+         c_entityCount, c_repeatCount, lookupMS, filterMS);
+}
+
+TEST(BenchmarkTests, JoinIteration)
+{
+  const uint32_t c_entityCount = 60000;
+  const uint32_t c_repeatCount = 20;
+  const uint32_t c_runCount = 5;
+
+  // World transforms on all entities, world bounds and bounds on 3/4 of them
+  GameContext context;
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(c_entityCount);
+  context.AddEntities(group, ECSIndex(c_entityCount), entities.data());
+  context.AddComponents<WorldTransforms>(group, entities[0].m_subID, ECSIndex(c_entityCount));
+
+  BenchRandom random;
+  std::vector<uint64_t> mask((c_entityCount + 63) >> 6, 0);
+  for (uint32_t i = 0; i < c_entityCount; i++)
+  {
+    if ((random.Next() & 0x3) != 0)
+    {
+      mask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+    }
+  }
+  context.AddComponents<WorldBounds>(group, mask.data());
+  context.AddComponents<Bounds>(group, mask.data());
+  for (auto& i : IterEntity<WorldBounds>(context, group))
+  {
+    i.GetCenter() = vec3(float(i.GetEntityID().m_subID));
+  }
+  for (auto& i : IterEntity<Bounds>(context, group))
+  {
+    i.GetExtents() = vec3(1.0f);
+  }
+
+  // Take the fastest of several runs of each, as single runs vary by more than the difference between them
+  float oneSum = 0.0f;
+  float filterSum = 0.0f;
+  float lookupSum = 0.0f;
+  float lookupSum3 = 0.0f;
+  float joinSum = 0.0f;
+  float joinSum3 = 0.0f;
+  double oneMS = 1e9;
+  double filterMS = 1e9;
+  double lookupMS = 1e9;
+  double lookupMS3 = 1e9;
+  double joinMS = 1e9;
+  double joinMS3 = 1e9;
+  for (uint32_t run = 0; run < c_runCount; run++)
+  {
+    // One component only
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : IterEntity<WorldBounds>(context, group))
+        {
+          oneSum += i.GetCenter().x;
+        }
+      }
+      oneMS = std::min(oneMS, timer.GetMS());
+    }
+
+    // Filtered by the second component, without accessing it
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : IterEntity<WorldTransforms, WorldBounds>(context, group))
+        {
+          filterSum += i.GetWorldScale().x;
+        }
+      }
+      filterMS = std::min(filterMS, timer.GetMS());
+    }
+
+    // Joined components looked up from the entity ID
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : IterEntity<WorldTransforms, WorldBounds>(context, group))
+        {
+          lookupSum += context.GetComponent<WorldBounds>(i.GetEntityID()).GetCenter().x + i.GetWorldScale().x;
+        }
+      }
+      lookupMS = std::min(lookupMS, timer.GetMS());
+    }
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : IterEntity<WorldTransforms, WorldBounds, Bounds>(context, group))
+        {
+          EntityID entity = i.GetEntityID();
+          lookupSum3 += context.GetComponent<WorldBounds>(entity).GetCenter().x + context.GetComponent<Bounds>(entity).GetExtents().x + i.GetWorldScale().x;
+        }
+      }
+      lookupMS3 = std::min(lookupMS3, timer.GetMS());
+    }
+
+    // Joined components from the iterator
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : IterEntity<WorldTransforms, WorldBounds>(context, group))
+        {
+          joinSum += i.GetComponent<WorldBounds>().GetCenter().x + i.GetWorldScale().x;
+        }
+      }
+      joinMS = std::min(joinMS, timer.GetMS());
+    }
+    {
+      BenchTimer timer;
+      for (uint32_t r = 0; r < c_repeatCount; r++)
+      {
+        for (auto& i : IterEntity<WorldTransforms, WorldBounds, Bounds>(context, group))
+        {
+          joinSum3 += i.GetComponent<WorldBounds>().GetCenter().x + i.GetComponent<Bounds>().GetExtents().x + i.GetWorldScale().x;
+        }
+      }
+      joinMS3 = std::min(joinMS3, timer.GetMS());
+    }
+  }
+
+  // Both must access the same components
+  EXPECT_EQ(lookupSum, joinSum);
+  EXPECT_EQ(lookupSum3, joinSum3);
+  EXPECT_GT(oneSum, 0.0f);
+  EXPECT_GT(filterSum, 0.0f);
+
+  printf("JoinIteration %u entities, %u passes (best of %u): 1 component %.2fms | filtered, no join %.2fms | GetComponent lookup 2 components %.2fms 3 components %.2fms | joined 2 components %.2fms 3 components %.2fms\n",
+         c_entityCount, c_repeatCount, c_runCount, oneMS, filterMS, lookupMS, lookupMS3, joinMS, joinMS3);
+}
+
+TEST(BenchmarkTests, FlagIteration)
+{
+  const uint32_t c_entityCount = UINT16_MAX;
+  const uint32_t c_repeatCount = 100;
+
+  // A component on all entities and a "dirty" flag on a random 1/64 of the entities
+  Context<BenchGroup> context;
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(c_entityCount);
+  context.AddEntities(group, ECSIndex(c_entityCount), entities.data());
+  context.AddComponents<EmptyManager>(group, entities[0].m_subID, ECSIndex(c_entityCount));
+
+  BenchRandom random;
+  for (uint32_t i = 0; i < c_entityCount; i++)
+  {
+    context.SetFlag<BenchFilter<1>>(entities[i], (random.Next() & 0x3F) == 0);
+  }
+
+  // Scanning every entity and testing the flag
+  uint32_t scanSum = 0;
+  double scanMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      for (auto& i : IterEntity<EmptyManager>(context))
+      {
+        if (context.HasFlag<BenchFilter<1>>(i.GetEntityID()))
+        {
+          scanSum += (ECSIndex)i.GetEntityID().m_subID;
+        }
+      }
+    }
+    scanMS = timer.GetMS();
+  }
+
+  // Iterating the set flags
+  uint32_t flagSum = 0;
+  double flagMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      for (auto& i : IterFlags<BenchFilter<1>>(context))
+      {
+        flagSum += (ECSIndex)i.GetEntityID().m_subID;
+      }
+    }
+    flagMS = timer.GetMS();
+  }
+
+  // Flag then component
+  uint32_t joinSum = 0;
+  double joinMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t r = 0; r < c_repeatCount; r++)
+    {
+      for (auto& i : IterFlags<BenchFilter<1>, EmptyManager>(context))
+      {
+        joinSum += i.GetComponent<EmptyManager>().m_index;
+      }
+    }
+    joinMS = timer.GetMS();
+  }
+
+  // Both must visit the same entities (the component index is the entity index as all entities have the component)
+  EXPECT_EQ(scanSum, flagSum);
+  EXPECT_EQ(scanSum, joinSum);
+  printf("FlagIteration %u entities, %u passes: scan with HasFlag %.2fms | IterFlags %.2fms | IterFlags with component %.2fms\n",
+         c_entityCount, c_repeatCount, scanMS, flagMS, joinMS);
+}
@@ -265,6 +265,24 @@ TEST(GameTests, Transforms)
     context.RemoveEntityGroup(groupID);
   }
 
+  // Bulk added bound volumes
+  {
+    GroupID groupID = context.AddEntityGroup();
+
+    EntityID entities[2];
+    context.AddEntities(groupID, 2, entities);
+
+    context.AddComponents<Transforms>(groupID, entities[0].m_subID, 2);
+    context.AddComponents<WorldTransforms>(groupID, entities[0].m_subID, 2);
+
+    uint64_t mask[] = { 0x3 };
+    context.AddComponents<Bounds>(groupID, mask);
+    context.AddComponents<WorldBounds>(groupID, mask);
+
+    RunTransformTests(context, entities[0], entities[1]);
+
+    context.RemoveEntityGroup(groupID);
+  }
 }
 
 TEST(GameTests, ParentChild)
@@ -526,6 +544,42 @@ TEST(GameTests, DeleteTransformTests)
     context.RemoveEntityGroup(groupID1);
   }
 
+  // Test entity batch deletion code
+  {
+    GroupID groupID1 = context.AddEntityGroup();
+    GroupID groupID2 = context.AddEntityGroup();
+
+    EntityID entity1 = context.AddEntity(groupID1);
+    EntityID entity2 = context.AddEntity(groupID2);
+    EntityID entity3 = context.AddEntity(groupID2);
+    EntityID entity4 = context.AddEntity(groupID1);
+    EntityID entity5 = context.AddEntity(groupID1);
+    context.AddComponent<Transforms>(entity1);
+    context.AddComponent<Transforms>(entity2);
+    context.AddComponent<Transforms>(entity3);
+    context.AddComponent<Transforms>(entity4);
+    context.AddComponent<Transforms>(entity5);
+
+    SetParent(context, entity1, entity2);
+    SetParent(context, entity3, entity1);
+    SetParent(context, entity4, entity2);
+    SetParent(context, entity5, entity2);
+
+    // Delete a parent, a child of it and a grand child of it (duplicate)
+    EntityID removeEntities[] = { entity4, entity2, entity3 };
+    context.RemoveEntities(removeEntities, 3);
+
+    // Everything should be deleted
+    EXPECT_FALSE(context.HasComponent<Transforms>(entity1));
+    EXPECT_FALSE(context.HasComponent<Transforms>(entity2));
+    EXPECT_FALSE(context.HasComponent<Transforms>(entity3));
+    EXPECT_FALSE(context.HasComponent<Transforms>(entity4));
+    EXPECT_FALSE(context.HasComponent<Transforms>(entity5));
+
+    context.RemoveEntityGroup(groupID2);
+    context.RemoveEntityGroup(groupID1);
+  }
+
   // Test entity group deletion code in reverse order
   {
     GroupID groupID1 = context.AddEntityGroup();
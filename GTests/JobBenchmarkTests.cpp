@@ -0,0 +1,163 @@
+// Linux benchmark of the job system against a std::thread per task and the Framework3 message posting Thread class.
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -pthread -ILib GTests/JobBenchmarkTests.cpp RunTest/Framework3/Util/Thread.cpp -lgtest_main -lgtest -o JobBenchmark
+#if !defined(_WIN32)
+
+#define GTEST_HAS_TR1_TUPLE 0
+#include "gtest/gtest.h"
+
+#include <ECSJobs.h>
+#include <ECSParallel.h>
+#include "../RunTest/Framework3/Util/Thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  const uint32_t c_taskCount = 2000;    //!< The count of tasks per pass
+  const uint32_t c_taskWork = 2000;     //!< The count of loop iterations of each task
+  const uint32_t c_threadCount = 4;     //!< The count of threads of each thread pool
+
+  /// \brief Simple timer, returning the elapsed time in milliseconds
+  class BenchTimer
+  {
+  public:
+
+    inline BenchTimer() : m_start(std::chrono::high_resolution_clock::now()) {}
+
+    inline double GetMS() const
+    {
+      return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_start).count();
+    }
+
+  private:
+    std::chrono::high_resolution_clock::time_point m_start; //!< The start time
+  };
+
+  /// \brief A small unit of work, similar in size to updating a few hundred entities
+  inline float RunTask(uint32_t i_task)
+  {
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < c_taskWork; i++)
+    {
+      sum += std::sqrt(float(i_task + i));
+    }
+    return sum;
+  }
+
+  /// \brief Runs a task for each message posted to it
+  class BenchThread : public Thread
+  {
+  public:
+
+    std::atomic<uint32_t> m_completed { 0 }; //!< The count of completed tasks
+    std::atomic<float> m_sum { 0.0f };       //!< The sum of all task results
+
+  protected:
+
+    void processMessage(const int /*thread*/, const int /*message*/, void* data, const int /*size*/) override
+    {
+      float result = RunTask(*static_cast<uint32_t*>(data));
+      float sum = m_sum;
+      while (!m_sum.compare_exchange_weak(sum, sum + result)) {}
+      m_completed++;
+    }
+  };
+}
+
+TEST(JobBenchmarkTests, Compare)
+{
+  std::vector<float> results(c_taskCount, 0.0f);
+  float expected = 0.0f;
+  for (uint32_t i = 0; i < c_taskCount; i++)
+  {
+    expected += RunTask(i);
+  }
+
+  // A new std::thread for each task (at most c_threadCount running at once)
+  double threadMS = 0.0;
+  {
+    BenchTimer timer;
+    for (uint32_t i = 0; i < c_taskCount; i += c_threadCount)
+    {
+      std::vector<std::thread> threads;
+      for (uint32_t t = i; t < i + c_threadCount && t < c_taskCount; t++)
+      {
+        threads.emplace_back([&results, t]() { results[t] = RunTask(t); });
+      }
+      for (std::thread& t : threads)
+      {
+        t.join();
+      }
+    }
+    threadMS = timer.GetMS();
+  }
+
+  // The Framework3 Thread class, posting a message per task
+  double messageMS = 0.0;
+  float messageSum = 0.0f;
+  {
+    BenchThread thread;
+    thread.startThreads(c_threadCount);
+
+    BenchTimer timer;
+    for (uint32_t i = 0; i < c_taskCount; i++)
+    {
+      thread.postMessage(i % c_threadCount, 0, &i, sizeof(i));
+    }
+    while (thread.m_completed != c_taskCount)
+    {
+      std::this_thread::yield();
+    }
+    messageMS = timer.GetMS();
+    messageSum = thread.m_sum;
+
+    thread.postMessage(ALL_THREADS, THREAD_QUIT);
+    thread.waitForExit();
+  }
+
+  // The job system, with a job per task and with fork/join ParallelFor
+  JobSystem jobs(c_threadCount);
+  double jobMS = 0.0;
+  {
+    BenchTimer timer;
+    JobCounter counter;
+    for (uint32_t i = 0; i < c_taskCount; i++)
+    {
+      jobs.Add([&results, i]() { results[i] = RunTask(i); }, &counter);
+    }
+    jobs.Wait(counter);
+    jobMS = timer.GetMS();
+  }
+
+  double parallelForMS = 0.0;
+  {
+    BenchTimer timer;
+    jobs.ParallelFor(c_taskCount, 16, [&results](uint32_t i_begin, uint32_t i_end)
+    {
+      for (uint32_t i = i_begin; i < i_end; i++)
+      {
+        results[i] = RunTask(i);
+      }
+    });
+    parallelForMS = timer.GetMS();
+  }
+
+  float jobSum = 0.0f;
+  for (float r : results)
+  {
+    jobSum += r;
+  }
+  EXPECT_NEAR(expected, jobSum, expected * 0.001f);
+  EXPECT_NEAR(expected, messageSum, expected * 0.001f);
+
+  printf("JobSystem %u tasks, %u threads: std::thread per task %.2fms | Thread messages %.2fms | JobSystem jobs %.2fms ParallelFor %.2fms\n",
+         c_taskCount, c_threadCount, threadMS, messageMS, jobMS, parallelForMS);
+}
+
+#endif // !_WIN32
@@ -3,6 +3,15 @@
 
 #include <ECS.h>
 #include <ECSIter.h>
+#include <ECSCommandBuffer.h>
+#include <ECSPagedManager.h>
+#include <ECSArena.h>
+#include <ECSSoAManager.h>
+#include <ECSAligned.h>
+#include <ECSParallel.h>
+#include <ECSJobs.h>
+#include <ECSSystems.h>
+#include <ECSQuery.h>
 
 struct TestData
 {
@@ -17,6 +26,8 @@ class FloatIDManager : public ComponentTypeIDManager<float> {};
 
 class IntManager : public ComponentTypeManager<int> {};
 class IntIDManager : public ComponentTypeIDManager<int> {};
+class IntPagedManager : public ComponentTypePagedManager<int> {};
+class IntSparseManager : public ComponentSparseSetManager<int> {};
 
 class TestFlagManager : public FlagManager {};
 class TestFlagManager2 : public FlagManager {};
@@ -36,6 +47,8 @@ public:
 
     AddManager(&intManager);
     AddManager(&intIDManager);
+    AddManager(&intPagedManager);
+    AddManager(&intSparseManager);
 
     AddManager(&flagManager);
     AddManager(&flagManager2);
@@ -49,6 +62,8 @@ public:
   FloatIDManager floatIDManager;
   IntManager intManager;
   IntIDManager intIDManager;
+  IntPagedManager intPagedManager;
+  IntSparseManager intSparseManager;
 
   TestFlagManager flagManager;
   TestFlagManager2 flagManager2;
@@ -61,6 +76,8 @@ template<> inline FloatManager& GetManager<FloatManager>(TestGroup& i_group) { r
 template<> inline FloatIDManager& GetManager<FloatIDManager>(TestGroup& i_group) { return i_group.floatIDManager; }
 template<> inline IntManager& GetManager<IntManager>(TestGroup& i_group) { return i_group.intManager; }
 template<> inline IntIDManager& GetManager<IntIDManager>(TestGroup& i_group) { return i_group.intIDManager; }
+template<> inline IntPagedManager& GetManager<IntPagedManager>(TestGroup& i_group) { return i_group.intPagedManager; }
+template<> inline IntSparseManager& GetManager<IntSparseManager>(TestGroup& i_group) { return i_group.intSparseManager; }
 
 template<> inline TestFlagManager& GetManager<TestFlagManager>(TestGroup& i_group) { return i_group.flagManager; }
 template<> inline TestFlagManager2& GetManager<TestFlagManager2>(TestGroup& i_group) { return i_group.flagManager2; }
@@ -68,6 +85,35 @@ template<> inline TestFlagManager2& GetManager<TestFlagManager2>(TestGroup& i_gr
 template<> inline FalseFlags& GetManager<FalseFlags>(TestGroup& i_group) { return i_group.falseFlags; }
 template<> inline EvenFlags& GetManager<EvenFlags>(TestGroup& i_group) { return i_group.evenFlags; }
 
+class ArenaIntManager : public ComponentTypeManager<int, ArenaAllocator<int>>
+{
+public:
+  using ComponentTypeManager::ComponentTypeManager;
+};
+
+class ArenaIntIDManager : public ComponentTypeIDManager<int, ArenaAllocator<int>>
+{
+public:
+  using ComponentTypeIDManager::ComponentTypeIDManager;
+};
+
+class ArenaGroup : public EntityGroup
+{
+public:
+
+  ArenaGroup()
+  {
+    AddManager(&intManager);
+    AddManager(&intIDManager);
+  }
+
+  GroupArena arena;
+  ArenaIntManager intManager{ ArenaAllocator<int>(arena) };
+  ArenaIntIDManager intIDManager{ ArenaAllocator<int>(arena) };
+};
+template<> inline ArenaIntManager& GetManager<ArenaIntManager>(ArenaGroup& i_group) { return i_group.intManager; }
+template<> inline ArenaIntIDManager& GetManager<ArenaIntIDManager>(ArenaGroup& i_group) { return i_group.intIDManager; }
+
 TEST(EntityTests, Basic)
 {
   auto context = Context<TestGroup>();
@@ -462,12 +508,12 @@ TEST(CreateTest, ComplexIterators)
   {
     EntityID entity = context.AddEntity(group);
     
-    auto& value1 = context.AddComponent<IntManager>(entity);
+    auto value1 = context.AddComponent<IntManager>(entity);
     *value1 = i;
 
     if ((i % 2) == 0)
     {
-      auto& value2 = context.AddComponent<IntIDManager>(entity);
+      auto value2 = context.AddComponent<IntIDManager>(entity);
       value2.GetData() = i;
     }
     if ((i % 3) == 0)
@@ -671,7 +717,7 @@ void TestBasicArray(Context<TestGroup>& i_context, const std::vector<int>& i_off
 
     for (auto& i : IterEntity<IntIDManager, EvenFlags>(i_context))
     {
-      EXPECT_TRUE(((uint16_t)i.GetEntityID().m_subID % 2) == 0);
+      EXPECT_TRUE(((ECSIndex)i.GetEntityID().m_subID % 2) == 0);
       EXPECT_TRUE(std::find(i_offsets.begin(), i_offsets.end(), (int)i.GetEntityID().m_subID) != i_offsets.end());
 
       index--;
@@ -812,7 +858,7 @@ void TestBasicArrayGroup(Context<TestGroup>& i_context, GroupID i_group, const s
 
     for (auto& i : IterEntity<IntIDManager, EvenFlags>(i_context, i_group))
     {
-      EXPECT_TRUE(((uint16_t)i.GetEntityID().m_subID % 2) == 0);
+      EXPECT_TRUE(((ECSIndex)i.GetEntityID().m_subID % 2) == 0);
       EXPECT_TRUE(std::find(i_offsets.begin(), i_offsets.end(), (int)i.GetEntityID().m_subID) != i_offsets.end());
       index--;
     }
@@ -1054,7 +1100,7 @@ void TestMultiArray(const std::vector<int>& i_offsets, const std::vector<int>& i
       context.SetFlag<TestFlagManager>(entity, true);
       context.AddComponent<IntManager>(entity);
 
-      if (((uint16_t)entity.m_subID % 2) == 0)
+      if (((ECSIndex)entity.m_subID % 2) == 0)
       {
         context.SetFlag<EvenFlags>(entity, true);
       }
@@ -1097,194 +1143,1790 @@ TEST(CreateTest, ComplexIterators3)
   TestMultiArray({ 128, 77, 63, 69 }, { 1234, 2, 4, 7 });
   TestMultiArray({ 129, 128, 26, 128 }, { 1234, 1235, 7, 8 });
 
+  // Span multiple prefix sum blocks (4096 entities per block)
+  TestMultiArray({ 4095, 4096 }, { 1234, 1235 });
+  TestMultiArray({ 0, 8191, 9000, 300 }, { 11, 12, 1234, 1235 });
 }
 
-// Debug only tests
-#ifndef NDEBUG
-
-TEST(DebugFailuresDeathTest, TooManyGroups)
+TEST(CreateTest, LargeGroup)
 {
   auto context = Context<TestGroup>();
-  context.ReserveGroups(UINT16_MAX);
+  GroupID group = context.AddEntityGroup();
+  context.ReserveEntities(group, 10000);
 
-  for (uint32_t i = 0; i < UINT16_MAX; i++)
+  // Add components in reverse order so each add updates the following prefix sums
+  std::vector<EntityID> entities;
+  for (int i = 0; i < 10000; i++)
   {
-    context.AddEntityGroup();
+    entities.push_back(context.AddEntity(group));
+  }
+  for (int i = 9999; i >= 0; i--)
+  {
+    if ((i % 3) != 0)
+    {
+      context.AddComponent<IntManager>(entities[i], i);
+    }
   }
 
-  EXPECT_DEATH(context.AddEntityGroup(), "Assertion failed");
-}
-
-TEST(DebugFailuresDeathTest, TooManyEntities)
-{
-  auto context = Context<TestGroup>();
-  GroupID group = context.AddEntityGroup();
-  context.ReserveEntities(group, UINT16_MAX);
+  // Remove components and entities across block boundaries
+  for (int i = 1; i < 10000; i += 7)
+  {
+    if (context.HasComponent<IntManager>(entities[i]))
+    {
+      context.RemoveComponent<IntManager>(entities[i]);
+    }
+  }
+  for (int i = 2; i < 10000; i += 11)
+  {
+    context.RemoveEntity(entities[i]);
+  }
 
-  for (uint32_t i = 0; i < UINT16_MAX; i++)
+  int count = 0;
+  for (int i = 0; i < 10000; i++)
   {
-    context.AddEntity(group);
+    bool expected = ((i % 3) != 0) && ((i - 1) % 7 != 0) && ((i - 2) % 11 != 0);
+    EXPECT_EQ(expected, context.HasComponent<IntManager>(entities[i]));
+    if (expected)
+    {
+      EXPECT_EQ(i, *context.GetComponent<IntManager>(entities[i]));
+      count++;
+    }
   }
+  EXPECT_EQ(count, (int)context.GetGroup(group)->intManager.GetComponentCount());
 
-  EXPECT_DEATH(context.AddEntity(group), "Assertion failed");
+  int iterCount = 0;
+  for (auto& v : IterEntity<IntManager>(context))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    iterCount++;
+  }
+  EXPECT_EQ(count, iterCount);
 }
 
-TEST(DebugFailuresDeathTest, DelGroups)
+TEST(CreateTest, DenseIteration)
 {
+  // Full bit data items (including one ending the group) and partial items, in two groups
   auto context = Context<TestGroup>();
+  std::vector<GroupID> groups;
+  std::vector<EntityID> expected;
+  for (int g = 0; g < 2; g++)
+  {
+    groups.push_back(context.AddEntityGroup());
+    std::vector<EntityID> entities(256);
+    context.AddEntities(groups[g], 256, entities.data());
+    for (int i = 0; i < 256; i++)
+    {
+      if (i < 128 || i == 130 || i == 140 || i >= 192)
+      {
+        context.AddComponent<IntManager>(entities[i], i);
+        context.AddComponent<IntSparseManager>(entities[i], i);
+        expected.push_back(entities[i]);
+      }
+    }
+  }
 
-  EXPECT_DEATH(context.RemoveEntityGroup((GroupID)0), "Assertion failed");
-}
-
-TEST(DebugFailuresDeathTest, InvalidID)
-{
-  auto context = Context<TestGroup>();
+  std::vector<EntityID> found;
+  for (auto& v : IterEntity<IntManager>(context))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    found.push_back(v.GetEntityID());
+  }
+  EXPECT_EQ(expected, found);
 
-  // Check invalid ID
-  EXPECT_DEATH(context.AddComponent<FloatManager>(EntityID_None), "IsValid");
+  found.clear();
+  for (GroupID group : groups)
+  {
+    for (auto& v : IterEntity<IntSparseManager>(context, group))
+    {
+      EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+      found.push_back(v.GetEntityID());
+    }
+  }
+  EXPECT_EQ(expected, found);
 }
 
-TEST(DebugFailuresDeathTest, InvalidGroup)
+TEST(CreateTest, AddEntities)
 {
   auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
 
-  EXPECT_DEATH(context.AddEntity((GroupID)0), "IsValid");
-}
+  std::vector<EntityID> entities(1000);
+  context.AddEntities(group, 1000, entities.data());
+  EXPECT_EQ(1000, (int)context.GetGroup(group)->GetEntityCount());
+  for (int i = 0; i < 1000; i++)
+  {
+    EXPECT_TRUE(entities[i] == (EntityID{ group, EntitySubID(i) }));
+    context.AddComponent<IntManager>(entities[i], i);
+    if ((i % 2) == 0)
+    {
+      context.SetFlag<EvenFlags>(entities[i], true);
+    }
+  }
 
-TEST(DebugFailuresDeathTest, InvalidEntityRemove)
-{
-  auto context = Context<TestGroup>();
+  // Re-use deleted ids first, in ascending order
+  context.RemoveEntity(entities[500]);
+  context.RemoveEntity(entities[10]);
+  context.AddEntities(group, 100, entities.data());
+  EXPECT_TRUE(entities[0] == (EntityID{ group, EntitySubID(10) }));
+  EXPECT_TRUE(entities[1] == (EntityID{ group, EntitySubID(500) }));
+  for (int i = 2; i < 100; i++)
+  {
+    EXPECT_TRUE(entities[i] == (EntityID{ group, EntitySubID(1000 + i - 2) }));
+    EXPECT_FALSE(context.HasComponent<IntManager>(entities[i]));
+    EXPECT_FALSE(context.HasFlag<EvenFlags>(entities[i]));
+    int value = 1000 + i - 2;
+    context.AddComponent<IntManager>(entities[i], value);
+  }
 
-  EXPECT_DEATH(context.RemoveEntity(EntityID_None), "IsValid");
+  // Existing data is unchanged by growing the group
+  int count = 0;
+  for (auto& v : IterEntity<IntManager>(context))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    count++;
+  }
+  EXPECT_EQ(1096, count);
 }
 
-TEST(DebugFailuresDeathTest, InvalidEntity2Remove)
+TEST(CreateTest, AddComponents)
 {
   auto context = Context<TestGroup>();
   GroupID group = context.AddEntityGroup();
 
-  EXPECT_DEATH(context.RemoveEntity(EntityID{ group , (EntitySubID)0}), "IsValid");
-}
+  std::vector<EntityID> entities(300);
+  context.AddEntities(group, 300, entities.data());
 
-TEST(DebugFailuresDeathTest, InvalidHasComponent)
-{
-  auto context = Context<TestGroup>();
+  // Add some single components, then bulk add around them
+  for (int i = 0; i < 300; i += 7)
+  {
+    context.AddComponent<IntIDManager>(entities[i], i);
+  }
 
-  EXPECT_DEATH(context.HasComponent<FloatManager>(EntityID_None), "IsValid");
-}
+  std::vector<uint64_t> mask(5, 0);
+  for (int i = 0; i < 300; i++)
+  {
+    if ((i % 7) != 0)
+    {
+      mask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+    }
+  }
+  context.AddComponents<IntIDManager>(group, mask.data());
 
-TEST(DebugFailuresDeathTest, InvalidGetComponentBadEntity)
-{
-  auto context = Context<TestGroup>();
+  // Range add with data
+  std::vector<int> values;
+  for (int i = 100; i < 250; i++)
+  {
+    values.push_back(i * 2);
+  }
+  context.AddComponents<IntManager>(group, EntitySubID(100), 150, values.data());
 
-  EXPECT_DEATH(context.GetComponent<FloatManager>(EntityID_None), "IsValid");
-}
+  // Default range add
+  context.AddComponents<FloatManager>(group, EntitySubID(0), 300);
 
-TEST(DebugFailuresDeathTest, InvalidGetComponentNoComponent)
-{
-  auto context = Context<TestGroup>();
-  GroupID group = context.AddEntityGroup();
-  EntityID entity = context.AddEntity(group);
+  EXPECT_EQ(300, (int)context.GetGroup(group)->intIDManager.GetComponentCount());
+  EXPECT_EQ(150, (int)context.GetGroup(group)->intManager.GetComponentCount());
+  EXPECT_EQ(300, (int)context.GetGroup(group)->floatManager.GetComponentCount());
+  for (int i = 0; i < 300; i++)
+  {
+    auto idComponent = context.GetComponent<IntIDManager>(entities[i]);
+    EXPECT_EQ((i % 7) == 0 ? i : 0, *idComponent);
+    EXPECT_TRUE(idComponent.GetSubID() == entities[i].m_subID);
 
-  EXPECT_DEATH(context.GetComponent<FloatManager>(entity), "Assertion failed");
+    EXPECT_EQ(i >= 100 && i < 250, context.HasComponent<IntManager>(entities[i]));
+    if (context.HasComponent<IntManager>(entities[i]))
+    {
+      EXPECT_EQ(i * 2, *context.GetComponent<IntManager>(entities[i]));
+    }
+  }
 }
 
-TEST(DebugFailuresDeathTest, InvalidAddComponentBadEntity)
+TEST(CreateTest, RemoveEntities)
 {
   auto context = Context<TestGroup>();
+  GroupID group1 = context.AddEntityGroup();
+  GroupID group2 = context.AddEntityGroup();
 
-  EXPECT_DEATH(context.AddComponent<FloatManager>(EntityID_None), "IsValid");
+  std::vector<EntityID> entities;
+  for (int i = 0; i < 400; i++)
+  {
+    EntityID entity = context.AddEntity((i % 2) == 0 ? group1 : group2);
+    entities.push_back(entity);
+    context.AddComponent<IntIDManager>(entity, i);
+    context.SetFlag<TestFlagManager>(entity, true);
+    if ((i % 3) == 0)
+    {
+      context.AddComponent<IntManager>(entity, i);
+    }
+  }
+
+  // Remove every 5th entity across both groups, out of order and with a duplicate
+  std::vector<EntityID> removeEntities;
+  for (int i = 395; i >= 0; i -= 5)
+  {
+    removeEntities.push_back(entities[i]);
+  }
+  removeEntities.push_back(entities[0]);
+  context.RemoveEntities(removeEntities.data(), (uint32_t)removeEntities.size());
+
+  for (int i = 0; i < 400; i++)
+  {
+    bool removed = (i % 5) == 0;
+    EXPECT_EQ(!removed, context.HasComponent<IntIDManager>(entities[i]));
+    EXPECT_EQ(!removed, context.HasFlag<TestFlagManager>(entities[i]));
+    EXPECT_EQ(!removed && (i % 3) == 0, context.HasComponent<IntManager>(entities[i]));
+    if (!removed)
+    {
+      EXPECT_EQ(i, *context.GetComponent<IntIDManager>(entities[i]));
+      EXPECT_TRUE(context.GetComponent<IntIDManager>(entities[i]).GetSubID() == entities[i].m_subID);
+    }
+    if (context.HasComponent<IntManager>(entities[i]))
+    {
+      EXPECT_EQ(i, *context.GetComponent<IntManager>(entities[i]));
+    }
+  }
+
+  // Deleted ids are re-used in ascending order
+  EXPECT_TRUE(context.AddEntity(group1) == entities[0]);
+  EXPECT_TRUE(context.AddEntity(group1) == entities[10]);
+  EXPECT_TRUE(context.AddEntity(group2) == entities[5]);
 }
 
-TEST(DebugFailuresDeathTest, DuplicateCreate)
+TEST(CreateTest, CommandBuffer)
 {
   auto context = Context<TestGroup>();
   GroupID group = context.AddEntityGroup();
-  EntityID entity = context.AddEntity(group);
+  GroupID group2 = context.AddEntityGroup();
+  for (int i = 0; i < 200; i++)
+  {
+    EntityID entity = context.AddEntity(group);
+    context.AddComponent<IntIDManager>(entity, i);
+  }
 
-  context.AddComponent<FloatManager>(entity);
+  // Record structural changes while iterating
+  CommandBuffer<TestGroup> commands;
+  EXPECT_TRUE(commands.IsEmpty());
+  for (auto& i : IterID<IntIDManager>(context))
+  {
+    int value = *i;
+    if ((value % 3) == 0)
+    {
+      commands.AddComponent<IntManager>(i.GetEntityID(), value);
+    }
+    if ((value % 5) == 0)
+    {
+      commands.RemoveComponent<IntIDManager>(i.GetEntityID());
+    }
+    if ((value % 7) == 0)
+    {
+      commands.RemoveEntity(i.GetEntityID());
+    }
+    if ((value % 10) == 0)
+    {
+      PendingEntityID newEntity = commands.AddEntity(group2);
+      commands.AddComponent<IntIDManager>(newEntity, value);
+      commands.AddComponent<FloatManager>(newEntity);
+    }
+  }
+  EXPECT_FALSE(commands.IsEmpty());
 
-  EXPECT_DEATH(context.AddComponent<FloatManager>(entity), "Assertion failed");
-}
+  std::vector<EntityID> created;
+  commands.Flush(context, &created);
+  EXPECT_TRUE(commands.IsEmpty());
 
-TEST(DebugFailuresDeathTest, InvalidRemoveComponentBadEntity)
-{
-  auto context = Context<TestGroup>();
+  for (int i = 0; i < 200; i++)
+  {
+    EntityID entity{ group, EntitySubID(i) };
+    bool removed = (i % 7) == 0;
+    EXPECT_EQ(!removed && (i % 3) == 0, context.HasComponent<IntManager>(entity));
+    EXPECT_EQ(!removed && (i % 5) != 0, context.HasComponent<IntIDManager>(entity));
+    if (context.HasComponent<IntManager>(entity))
+    {
+      EXPECT_EQ(i, *context.GetComponent<IntManager>(entity));
+    }
+    if (context.HasComponent<IntIDManager>(entity))
+    {
+      EXPECT_EQ(i, *context.GetComponent<IntIDManager>(entity));
+    }
+  }
 
-  EXPECT_DEATH(context.RemoveComponent<FloatManager>(EntityID_None), "IsValid");
-}
+  // Check sub IDs are kept in order with the data
+  for (auto& i : IterID<IntIDManager>(context, group))
+  {
+    EXPECT_EQ((int)i.GetEntityID().m_subID, *i);
+  }
 
-TEST(DebugFailuresDeathTest, InvalidRemove)
-{
-  auto context = Context<TestGroup>();
-  GroupID group = context.AddEntityGroup();
-  EntityID entity = context.AddEntity(group);
+  // Check the created entities
+  EXPECT_EQ(20, (int)created.size());
+  for (uint32_t i = 0; i < created.size(); i++)
+  {
+    EXPECT_TRUE(created[i].m_groupID == group2);
+    EXPECT_EQ((int)i * 10, *context.GetComponent<IntIDManager>(created[i]));
+    EXPECT_TRUE(context.HasComponent<FloatManager>(created[i]));
+  }
 
-  EXPECT_DEATH(context.RemoveComponent<FloatManager>(entity), "Assertion failed");
+  // Re-use of the buffer after a flush
+  commands.AddComponent<IntManager>(created[0], 5);
+  commands.AddComponent<IntManager>(created[1], uint8_t(6)); // (converted to the manager's DataType when recorded)
+  commands.RemoveComponent<IntIDManager>(created[0]);
+  commands.Flush(context);
+  EXPECT_EQ(5, *context.GetComponent<IntManager>(created[0]));
+  EXPECT_EQ(6, *context.GetComponent<IntManager>(created[1]));
+  EXPECT_FALSE(context.HasComponent<IntIDManager>(created[0]));
 }
 
-TEST(DebugFailuresDeathTest, DuplicateRemove)
+#if defined(AT_ECS_32BIT_IDS)
+TEST(CreateTest, LargeIDs)
 {
   auto context = Context<TestGroup>();
   GroupID group = context.AddEntityGroup();
-  EntityID entity = context.AddEntity(group);
-
-  context.AddComponent<FloatManager>(entity);
-  context.RemoveComponent<FloatManager>(entity);
 
-  EXPECT_DEATH(context.RemoveComponent<FloatManager>(entity), "Assertion failed");
-}
+  // Create more entities than 16 bit ids support
+  const ECSIndex c_count = 200000;
+  std::vector<EntityID> entities(c_count);
+  context.AddEntities(group, c_count, entities.data());
+  EXPECT_EQ(c_count - 1, (ECSIndex)entities.back().m_subID);
 
-TEST(DebugFailuresDeathTest, InvalidGetGroup)
-{
-  auto context = Context<TestGroup>();
+  std::vector<int> values(c_count / 2);
+  for (ECSIndex i = 0; i < c_count / 2; i++)
+  {
+    values[i] = (int)(i * 2 + 1);
+  }
+  context.AddComponents<IntManager>(group, EntitySubID(c_count / 2), c_count / 2, values.data());
+  EXPECT_EQ(c_count / 2, context.GetGroup(group)->intManager.GetComponentCount());
+  EXPECT_EQ((int)c_count - 1, *context.GetComponent<IntManager>(entities.back()));
 
-  EXPECT_DEATH(context.GetGroup(EntityID_None), "IsValid");
+  context.RemoveEntity(entities[c_count - 2]);
+  ECSIndex count = 0;
+  for (auto& v : IterEntity<IntManager>(context, group))
+  {
+    EXPECT_NE(c_count - 2, (ECSIndex)v.GetEntityID().m_subID);
+    count++;
+  }
+  EXPECT_EQ(c_count / 2 - 1, count);
 }
+#endif
 
-TEST(DebugFailuresDeathTest, InvalidHasFlag)
+TEST(CreateTest, DeletedReuse)
 {
   auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(10000);
+  context.AddEntities(group, 10000, entities.data());
 
-  EXPECT_DEATH(context.HasFlag<TestFlagManager>(EntityID_None), "IsValid");
+  // Remove in descending order across many bit data items, including a double delete
+  for (int i = 9999; i >= 0; i -= 3)
+  {
+    context.RemoveEntity(entities[i]);
+  }
+  context.RemoveEntity(entities[9999]);
+  EntityID removeIDs[] = { entities[1], entities[9996] };
+  context.RemoveEntities(removeIDs, 2);
+
+  // Deleted ids are re-used lowest first, before any new ids
+  EXPECT_EQ(0, (int)context.AddEntity(group).m_subID);
+  EXPECT_EQ(1, (int)context.AddEntity(group).m_subID);
+  std::vector<EntityID> reused(3334);
+  context.AddEntities(group, 3334, reused.data());
+  for (int i = 0; i < 3333; i++)
+  {
+    EXPECT_EQ(3 + i * 3, (int)reused[i].m_subID);
+  }
+  EXPECT_EQ(10000, (int)reused[3333].m_subID);
+  EXPECT_EQ(10001, (int)context.GetGroup(group)->GetEntityCount());
 }
 
-TEST(DebugFailuresDeathTest, InvalidSetFlag)
+void TestPagedMatches(Context<TestGroup>& i_context, GroupID i_group)
 {
-  auto context = Context<TestGroup>();
+  const TestGroup& group = *i_context.GetGroup(i_group);
+  const IntManager& intManager = group.intManager;
+  const IntPagedManager& pagedManager = group.intPagedManager;
+  ASSERT_EQ(intManager.GetBits(), pagedManager.GetBits());
+  ASSERT_EQ(intManager.GetComponentCount(), pagedManager.GetComponentCount());
 
-  EXPECT_DEATH(context.SetFlag<TestFlagManager>(EntityID_None, true), "IsValid");
-}
+  // Iterate in component order
+  std::vector<int> values;
+  for (auto& v : Iter<IntPagedManager>(i_context, i_group))
+  {
+    values.push_back(*v);
+  }
+  EXPECT_EQ(intManager.m_data, values);
 
-TEST(DebugFailuresDeathTest, InvalidReserveEntities)
-{
-  auto context = Context<TestGroup>();
+  // Iterate the page spans
+  values.clear();
+  for (uint32_t p = 0; p < pagedManager.GetPageCount(); p++)
+  {
+    const int* data = pagedManager.GetPageData(p);
+    for (ECSIndex i = 0; i < pagedManager.GetPageComponentCount(p); i++)
+    {
+      values.push_back(data[i]);
+    }
+  }
+  EXPECT_EQ(intManager.m_data, values);
 
-  EXPECT_DEATH(context.ReserveEntities(EntityID_None.m_groupID, 10), "IsValid");
+  // Random access and entity iteration
+  for (auto& v : IterEntity<IntPagedManager>(i_context, i_group))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    EXPECT_EQ(*i_context.GetComponent<IntManager>(v.GetEntityID()), *i_context.GetComponent<IntPagedManager>(v.GetEntityID()));
+  }
 }
 
-TEST(DebugFailuresDeathTest, InvalidReserveComponent)
+TEST(CreateTest, PagedManager)
 {
   auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(5000);
+  context.AddEntities(group, 5000, entities.data());
 
-  EXPECT_DEATH(context.ReserveComponent<FloatManager>(EntityID_None.m_groupID, 10), "IsValid");
+  // Single adds out of order, then a batch add
+  for (int i = 4999; i >= 0; i -= 3)
+  {
+    context.AddComponent<IntManager>(entities[i], i);
+    context.AddComponent<IntPagedManager>(entities[i], i);
+  }
+  std::vector<uint64_t> mask(context.GetGroup(group)->intManager.GetBits().size(), 0);
+  for (int i = 1000; i < 2000; i++)
+  {
+    if (!context.HasComponent<IntManager>(entities[i]))
+    {
+      mask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+    }
+  }
+  context.AddComponents<IntManager>(group, mask.data());
+  context.AddComponents<IntPagedManager>(group, mask.data());
+  for (auto& v : IterEntity<IntManager>(context, group))
+  {
+    *v = (int)v.GetEntityID().m_subID;
+  }
+  for (auto& v : IterEntity<IntPagedManager>(context, group))
+  {
+    *v = (int)v.GetEntityID().m_subID;
+  }
+  TestPagedMatches(context, group);
+
+  // Single and batch removes
+  for (int i = 1; i < 5000; i += 7)
+  {
+    if (context.HasComponent<IntManager>(entities[i]))
+    {
+      context.RemoveComponent<IntManager>(entities[i]);
+      context.RemoveComponent<IntPagedManager>(entities[i]);
+    }
+  }
+  context.RemoveEntity(entities[1500]);
+  std::vector<EntityID> removeIDs;
+  for (int i = 0; i < 5000; i += 5)
+  {
+    removeIDs.push_back(entities[i]);
+  }
+  context.RemoveEntities(removeIDs.data(), (uint32_t)removeIDs.size());
+  TestPagedMatches(context, group);
 }
 
-TEST(DebugFailuresDeathTest, HoldReference)
+void TestSparseMatches(Context<TestGroup>& i_context, GroupID i_group)
 {
-  auto context = Context<TestGroup>();
-  GroupID group = context.AddEntityGroup();
-  EntityID entity = context.AddEntity(group);
+  const TestGroup& group = *i_context.GetGroup(i_group);
+  ASSERT_EQ(group.intManager.GetBits(), group.intSparseManager.GetBits());
+  ASSERT_EQ(group.intManager.GetComponentCount(), (ECSIndex)group.intSparseManager.m_data.size());
 
-  auto newItem = context.AddComponent<FloatManager>(entity);
+  // Storage order iteration visits every component once
+  int sum = 0;
+  int count = 0;
+  for (auto& v : IterID<IntSparseManager>(i_context, i_group))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    sum += *v;
+    count++;
+  }
+  int expectedSum = 0;
+  for (int v : group.intManager.m_data)
+  {
+    expectedSum += v;
+  }
+  EXPECT_EQ(expectedSum, sum);
+  EXPECT_EQ((int)group.intManager.GetComponentCount(), count);
 
-  EntityID entity2 = context.AddEntity(group);
+  // Entity order iteration, with the sparse manager first and as a filter
+  std::vector<int> values;
+  for (auto& v : IterEntity<IntSparseManager>(i_context, i_group))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    EXPECT_EQ(*v, *i_context.GetComponent<IntSparseManager>(v.GetEntityID()));
+    values.push_back(*v);
+  }
+  EXPECT_EQ(group.intManager.m_data, values);
 
-  // Check that adding a component on the group fails while holding a reference
-  EXPECT_DEATH(context.AddComponent<FloatManager>(entity2), "Assertion failed");
+  values.clear();
+  for (auto& v : IterEntity<IntSparseManager, IntManager>(i_context))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    values.push_back(*v);
+  }
+  EXPECT_EQ(group.intManager.m_data, values);
+
+  values.clear();
+  for (auto& v : IterEntity<IntManager, IntSparseManager>(i_context, i_group))
+  {
+    EXPECT_EQ(*v, *i_context.GetComponent<IntSparseManager>(v.GetEntityID()));
+    values.push_back(*v);
+  }
+  EXPECT_EQ(group.intManager.m_data, values);
 }
 
-TEST(DebugFailuresDeathTest, DelHoldReference)
+TEST(CreateTest, SparseSetManager)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(3000);
+  context.AddEntities(group, 3000, entities.data());
+
+  // Single adds out of order, then a batch add
+  for (int i = 2999; i >= 0; i -= 3)
+  {
+    context.AddComponent<IntManager>(entities[i], i);
+    EXPECT_EQ(i, *context.AddComponent<IntSparseManager>(entities[i], i));
+  }
+  std::vector<uint64_t> mask(context.GetGroup(group)->intManager.GetBits().size(), 0);
+  for (int i = 1000; i < 1100; i++)
+  {
+    if (!context.HasComponent<IntManager>(entities[i]))
+    {
+      mask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+    }
+  }
+  context.AddComponents<IntManager>(group, mask.data());
+  context.AddComponents<IntSparseManager>(group, mask.data());
+  for (auto& v : IterEntity<IntManager>(context, group))
+  {
+    *v = (int)v.GetEntityID().m_subID;
+  }
+  for (auto& v : IterEntity<IntSparseManager>(context, group))
+  {
+    *v = (int)v.GetEntityID().m_subID;
+  }
+  TestSparseMatches(context, group);
+
+  // Single and batch removes
+  for (int i = 1; i < 3000; i += 7)
+  {
+    if (context.HasComponent<IntManager>(entities[i]))
+    {
+      context.RemoveComponent<IntManager>(entities[i]);
+      context.RemoveComponent<IntSparseManager>(entities[i]);
+    }
+  }
+  context.RemoveEntity(entities[1050]);
+  std::vector<EntityID> removeIDs;
+  for (int i = 0; i < 3000; i += 5)
+  {
+    removeIDs.push_back(entities[i]);
+  }
+  context.RemoveEntities(removeIDs.data(), (uint32_t)removeIDs.size());
+  TestSparseMatches(context, group);
+}
+
+TEST(CreateTest, GroupPool)
+{
+  auto context = Context<TestGroup>();
+  context.SetGroupPoolSize(1);
+
+  auto fillGroup = [&context](GroupID i_group)
+  {
+    std::vector<EntityID> entities(3000);
+    context.AddEntities(i_group, 3000, entities.data());
+    for (int i = 0; i < 3000; i += 2)
+    {
+      context.AddComponent<IntManager>(entities[i], i);
+      context.AddComponent<IntPagedManager>(entities[i], i);
+      context.AddComponent<IntSparseManager>(entities[i], i);
+      context.SetFlag<EvenFlags>(entities[i], true);
+    }
+    context.RemoveEntity(entities[100]);
+  };
+
+  GroupID group = context.AddEntityGroup();
+  GroupID group2 = context.AddEntityGroup();
+  fillGroup(group);
+  const TestGroup* groupPtr = context.GetGroup(group);
+  size_t capacity = groupPtr->intManager.m_data.capacity();
+
+  // The first removed group is pooled, the second is deleted as the pool is full
+  context.RemoveEntityGroup(group);
+  context.RemoveEntityGroup(group2);
+  EXPECT_EQ(1, (int)context.GetPooledGroupCount());
+
+  // The pooled group is handed back empty, with the capacity kept
+  GroupID newGroup = context.AddEntityGroup();
+  EXPECT_EQ(0, (int)context.GetPooledGroupCount());
+  const TestGroup* newGroupPtr = context.GetGroup(newGroup);
+  EXPECT_EQ(groupPtr, newGroupPtr);
+  EXPECT_EQ(0, (int)newGroupPtr->GetEntityCount());
+  EXPECT_EQ(0, (int)newGroupPtr->intManager.GetComponentCount());
+  EXPECT_EQ(0, (int)newGroupPtr->intPagedManager.GetComponentCount());
+  EXPECT_EQ(0, (int)newGroupPtr->intSparseManager.m_data.size());
+  EXPECT_EQ(0, (int)newGroupPtr->evenFlags.GetBits().size());
+  EXPECT_EQ(capacity, newGroupPtr->intManager.m_data.capacity());
+
+  // The re-used group behaves as a new group
+  fillGroup(newGroup);
+  EXPECT_EQ(1499, (int)newGroupPtr->intManager.GetComponentCount());
+  TestPagedMatches(context, newGroup);
+  TestSparseMatches(context, newGroup);
+  int flagCount = 0;
+  for (auto& i : IterEntity<IntManager, EvenFlags>(context, newGroup))
+  {
+    EXPECT_TRUE(context.HasFlag<EvenFlags>(i.GetEntityID()));
+    flagCount++;
+  }
+  EXPECT_EQ(1499, flagCount);
+
+  // Shrinking the pool deletes the extra groups
+  context.RemoveEntityGroup(newGroup);
+  EXPECT_EQ(1, (int)context.GetPooledGroupCount());
+  context.SetGroupPoolSize(0);
+  EXPECT_EQ(0, (int)context.GetPooledGroupCount());
+}
+
+typedef StaticEntityGroup<IntManager, IntIDManager, IntPagedManager, IntSparseManager, EvenFlags> StaticTestGroup;
+
+TEST(CreateTest, StaticGroup)
+{
+  auto context = Context<StaticTestGroup>();
+  context.SetGroupPoolSize(1);
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(3000);
+  context.AddEntities(group, 3000, entities.data());
+  EntityID single = context.AddEntity(group);
+  EXPECT_EQ(3000, (int)single.m_subID);
+
+  for (int i = 0; i < 3000; i++)
+  {
+    context.AddComponent<IntManager>(entities[i], i);
+    if ((i % 2) == 0)
+    {
+      context.AddComponent<IntIDManager>(entities[i], i);
+      context.AddComponent<IntPagedManager>(entities[i], i);
+      context.AddComponent<IntSparseManager>(entities[i], i);
+      context.SetFlag<EvenFlags>(entities[i], true);
+    }
+  }
+
+  // Removing entities without a flag does not change its version
+  StaticTestGroup& staticGroup = *context.GetGroup(group);
+  uint64_t flagVersion = staticGroup.GetManager<EvenFlags>().GetVersion();
+  context.RemoveEntity(entities[11]);
+  EXPECT_EQ(flagVersion, staticGroup.GetManager<EvenFlags>().GetVersion());
+
+  // Remove single entities and a batch
+  context.RemoveEntity(entities[10]);
+  EXPECT_NE(flagVersion, staticGroup.GetManager<EvenFlags>().GetVersion());
+  std::vector<EntityID> removeIDs;
+  for (int i = 1000; i < 2000; i += 3)
+  {
+    removeIDs.push_back(entities[i]);
+  }
+  context.RemoveEntities(removeIDs.data(), (uint32_t)removeIDs.size());
+  EXPECT_FALSE(context.HasFlag<EvenFlags>(entities[10]));
+  EXPECT_FALSE(context.HasComponent<IntSparseManager>(entities[1000]));
+
+  // All managers agree with the entity ids
+  int count = 0;
+  for (auto& v : IterEntity<IntIDManager, EvenFlags>(context, group))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    EXPECT_EQ(*v, *context.GetComponent<IntPagedManager>(v.GetEntityID()));
+    EXPECT_EQ(*v, *context.GetComponent<IntSparseManager>(v.GetEntityID()));
+    count++;
+  }
+  EXPECT_EQ(1499 - 167, count);
+  EXPECT_EQ(count, (int)staticGroup.GetManager<IntPagedManager>().GetComponentCount());
+  EXPECT_EQ(count, (int)staticGroup.GetManager<IntSparseManager>().m_data.size());
+  EXPECT_EQ(3000 - 2 - 334, (int)GetManager<IntManager>(staticGroup).GetComponentCount());
+
+  // Deleted ids are re-used
+  EXPECT_EQ(10, (int)context.AddEntity(group).m_subID);
+
+  // Pooled static groups are reset
+  context.RemoveEntityGroup(group);
+  GroupID newGroup = context.AddEntityGroup();
+  EXPECT_EQ(&staticGroup, context.GetGroup(newGroup));
+  EXPECT_EQ(0, (int)staticGroup.GetEntityCount());
+  EXPECT_EQ(0, (int)staticGroup.GetManager<IntManager>().GetComponentCount());
+  EXPECT_EQ(0, (int)staticGroup.GetManager<IntSparseManager>().m_data.size());
+  EXPECT_EQ(0, (int)staticGroup.GetManager<EvenFlags>().GetBits().size());
+}
+
+struct SoAInt : SoAField<int> {};
+struct SoAFloat : SoAField<float> { static inline float Default() { return 1.5f; } };
+class SoATestManager : public SoAComponentManager<SoAInt, SoAFloat> {};
+typedef StaticEntityGroup<SoATestManager, IntManager> SoATestGroup;
+
+TEST(CreateTest, SoAManager)
+{
+  auto context = Context<SoATestGroup>();
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(1000);
+  context.AddEntities(group, 1000, entities.data());
+
+  // Single adds with and without values, then a batch add
+  for (int i = 999; i >= 0; i -= 2)
+  {
+    int value = i;
+    float floatValue = i * 0.5f;
+    auto c = context.AddComponent<SoATestManager>(entities[i], value, floatValue);
+    EXPECT_EQ(i, c.Get<SoAInt>());
+    EXPECT_EQ(i * 0.5f, c.Get<1>());
+  }
+  context.AddComponent<SoATestManager>(entities[0]);
+  std::vector<uint64_t> mask((1000 + 63) / 64, 0);
+  for (int i = 2; i < 1000; i += 2)
+  {
+    mask[i >> 6] |= uint64_t(1) << (i & 0x3F);
+  }
+  context.AddComponents<SoATestManager>(group, mask.data());
+
+  // Fields stay in entity order
+  SoATestManager& manager = GetManager<SoATestManager>(*context.GetGroup(group));
+  EXPECT_EQ(1000, (int)manager.GetComponentCount());
+  for (auto& c : IterEntity<SoATestManager>(context, group))
+  {
+    int subID = (int)c.GetEntityID().m_subID;
+    EXPECT_EQ((subID % 2) == 1 ? subID : 0, c.Get<SoAInt>());
+    EXPECT_EQ((subID % 2) == 1 ? subID * 0.5f : 1.5f, c.Get<SoAFloat>());
+  }
+
+  // Remove single and batch, then check the spans
+  context.RemoveEntity(entities[1]);
+  std::vector<EntityID> removeIDs(entities.begin() + 500, entities.end());
+  context.RemoveEntities(removeIDs.data(), (uint32_t)removeIDs.size());
+  EXPECT_EQ(499, (int)manager.GetSpan<SoAInt>().size());
+  EXPECT_EQ(499, (int)manager.GetSpan<SoAFloat>().size());
+  int index = 0;
+  for (int v : manager.GetSpan<SoAInt>())
+  {
+    int subID = (index == 0) ? 0 : index + 1;
+    EXPECT_EQ((subID % 2) == 1 ? subID : 0, v);
+    index++;
+  }
+  for (float& v : manager.GetSpan<SoAFloat>())
+  {
+    v = 2.0f;
+  }
+  EXPECT_EQ(2.0f, context.GetComponent<SoATestManager>(entities[3]).Get<SoAFloat>());
+
+  // Batch add with data, from per field arrays and from a command buffer
+  GroupID group2 = context.AddEntityGroup();
+  EntityID entities2[8];
+  context.AddEntities(group2, 8, entities2);
+  int ints[] = { 10, 11, 12, 13 };
+  float floats[] = { 20.0f, 21.0f, 22.0f, 23.0f };
+  context.AddComponents<SoATestManager>(group2, entities2[2].m_subID, 4, ints, floats);
+
+  CommandBuffer<SoATestGroup> commands;
+  commands.AddComponent<SoATestManager>(entities2[7], SoATestManager::Values(17, 27.0f));
+  commands.AddComponent<SoATestManager>(entities2[0], SoATestManager::Values(7, 17.0f));
+  commands.Flush(context);
+
+  std::vector<int> foundInts;
+  std::vector<float> foundFloats;
+  for (auto& c : IterEntity<SoATestManager>(context, group2))
+  {
+    foundInts.push_back(c.Get<SoAInt>());
+    foundFloats.push_back(c.Get<SoAFloat>());
+  }
+  EXPECT_EQ(std::vector<int>({ 7, 10, 11, 12, 13, 17 }), foundInts);
+  EXPECT_EQ(std::vector<float>({ 17.0f, 20.0f, 21.0f, 22.0f, 23.0f, 27.0f }), foundFloats);
+}
+
+struct Lane8Field : SoALaneField<8> {};
+struct Lane16Field : SoALaneField<16> {};
+class LaneTestManager : public SoAComponentManager<Lane8Field, Lane16Field, SoAInt> {};
+class AlignedFloatManager : public ComponentTypeManager<float, AlignedAllocator<float, 32>> {};
+typedef StaticEntityGroup<LaneTestManager, AlignedFloatManager> LaneTestGroup;
+
+TEST(CreateTest, SoALaneFields)
+{
+  auto context = Context<LaneTestGroup>();
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(100);
+  context.AddEntities(group, 100, entities.data());
+
+  LaneTestManager& manager = GetManager<LaneTestManager>(*context.GetGroup(group));
+  AlignedFloatManager& floatManager = GetManager<AlignedFloatManager>(*context.GetGroup(group));
+  for (int count = 1; count <= 40; count++)
+  {
+    context.AddComponent<LaneTestManager>(entities[count - 1]).Get<Lane8Field>() = 1.0f;
+    context.AddComponent<AlignedFloatManager>(entities[count - 1]);
+
+    // Arrays are aligned to the lane width, and padded to a multiple of it
+    auto span8 = manager.GetSpan<Lane8Field>();
+    auto span16 = manager.GetSpan<Lane16Field>();
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(span8.begin()) % 32);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(span16.begin()) % 64);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(floatManager.m_data.data()) % 32);
+    EXPECT_EQ((uint32_t)(count + 7) / 8 * 8, span8.GetPaddedSize());
+    EXPECT_EQ((uint32_t)(count + 15) / 16 * 16, span16.GetPaddedSize());
+    EXPECT_EQ((uint32_t)count, manager.GetSpan<SoAInt>().GetPaddedSize());
+
+    // Process 8 lanes at a time, with no masking as the padding is zero
+    float lanes[8] = {};
+    for (uint32_t i = 0; i < span8.GetPaddedSize(); i += 8)
+    {
+      for (uint32_t l = 0; l < 8; l++)
+      {
+        lanes[l] += span8[i + l];
+      }
+    }
+    float sum = 0.0f;
+    for (float lane : lanes)
+    {
+      sum += lane;
+    }
+    EXPECT_EQ((float)count, sum);
+    for (uint32_t i = span16.size(); i < span16.GetPaddedSize(); i++)
+    {
+      EXPECT_EQ(0.0f, span16.begin()[i]);
+    }
+  }
+
+  // Padding stays zero after removes and re-allocation (including values moved out of the array)
+  context.RemoveEntity(entities[0]);
+  EntityID removeIDs[] = { entities[5], entities[6], entities[7] };
+  context.RemoveEntities(removeIDs, 3);
+  manager.ReserveComponent(200);
+  auto span8 = manager.GetSpan<Lane8Field>();
+  EXPECT_EQ(36u, span8.size());
+  for (uint32_t i = span8.size(); i < span8.GetPaddedSize(); i++)
+  {
+    EXPECT_EQ(0.0f, span8.begin()[i]);
+  }
+}
+
+TEST(CreateTest, ParallelForEach)
+{
+  auto context = Context<TestGroup>();
+  std::vector<GroupID> groups;
+  for (int g = 0; g < 4; g++)
+  {
+    GroupID group = context.AddEntityGroup();
+    groups.push_back(group);
+    std::vector<EntityID> entities(5000);
+    context.AddEntities(group, 5000, entities.data());
+    for (int i = g * 100; i < 5000; i += (g + 1))
+    {
+      context.AddComponent<IntManager>(entities[i], i);
+      context.AddComponent<IntSparseManager>(entities[i], i);
+      if ((i % 2) == 0)
+      {
+        context.SetFlag<EvenFlags>(entities[i], true);
+      }
+    }
+  }
+  context.RemoveEntityGroup(groups[2]);
+
+  // Each entity is visited once, with the matching component
+  TaskPool pool(4);
+  std::atomic<int> count { 0 };
+  ParallelForEach<IntManager>(pool, context, [&count](auto& i)
+  {
+    EXPECT_EQ((int)i.GetEntityID().m_subID, *i);
+    *i += 1;
+    count++;
+  });
+  int expectedCount = 0;
+  for (auto& i : IterEntity<IntManager>(context))
+  {
+    EXPECT_EQ((int)i.GetEntityID().m_subID + 1, *i);
+    expectedCount++;
+  }
+  EXPECT_EQ(expectedCount, count);
+
+  // Filters, unordered managers, single groups and the default pool
+  count = 0;
+  ParallelForEach<IntSparseManager, EvenFlags>(pool, context, [&count, &context](auto& i)
+  {
+    EXPECT_EQ((int)i.GetEntityID().m_subID, *i);
+    EXPECT_TRUE(context.template HasFlag<EvenFlags>(i.GetEntityID()));
+    count++;
+  });
+  expectedCount = 0;
+  for (auto& i : IterEntity<IntSparseManager, EvenFlags>(context))
+  {
+    expectedCount++;
+  }
+  EXPECT_EQ(expectedCount, count);
+
+  count = 0;
+  ParallelForEach<IntManager>(context, groups[1], [&count, &groups](auto& i)
+  {
+    EXPECT_EQ(groups[1], i.GetEntityID().m_groupID);
+    count++;
+  });
+  EXPECT_EQ(2450, count);
+}
+
+TEST(CreateTest, JobSystem)
+{
+  JobSystem jobs(4);
+
+  // Jobs with a counter, and nested fork/join inside jobs
+  std::vector<int> values(1000, 0);
+  JobCounter counter;
+  for (int j = 0; j < 10; j++)
+  {
+    jobs.Add([&jobs, &values, j]()
+    {
+      jobs.ParallelFor(100, 7, [&values, j](uint32_t i_begin, uint32_t i_end)
+      {
+        for (uint32_t i = i_begin; i < i_end; i++)
+        {
+          values[j * 100 + i] += (int)(j * 100 + i);
+        }
+      });
+    }, &counter);
+  }
+  jobs.Wait(counter);
+  EXPECT_TRUE(counter.IsDone());
+  for (int i = 0; i < 1000; i++)
+  {
+    EXPECT_EQ(i, values[i]);
+  }
+
+  // Continuations start when all jobs of the dependency are complete
+  std::atomic<int> stage { 0 };
+  std::atomic<int> firstDone { 0 };
+  JobCounter first;
+  JobCounter second;
+  for (int j = 0; j < 8; j++)
+  {
+    jobs.Add([&stage, &firstDone]() { EXPECT_EQ(0, stage.load()); firstDone++; }, &first);
+  }
+  jobs.AddAfter(first, [&stage, &firstDone]() { EXPECT_EQ(8, firstDone.load()); stage = 1; }, &second);
+  jobs.Wait(second);
+  EXPECT_EQ(1, stage.load());
+
+  // A continuation of a complete counter is added immediately
+  JobCounter third;
+  jobs.AddAfter(first, [&stage]() { stage = 2; }, &third);
+  jobs.Wait(third);
+  EXPECT_EQ(2, stage.load());
+
+  // The job system can run ParallelForEach
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(5000);
+  context.AddEntities(group, 5000, entities.data());
+  for (int i = 0; i < 5000; i += 3)
+  {
+    context.AddComponent<IntManager>(entities[i], i);
+  }
+  std::atomic<int> count { 0 };
+  ParallelForEach<IntManager>(jobs, context, [&count](auto& i)
+  {
+    EXPECT_EQ((int)i.GetEntityID().m_subID, *i);
+    count++;
+  });
+  EXPECT_EQ(1667, count);
+}
+
+TEST(CreateTest, SystemScheduler)
+{
+  SystemScheduler scheduler;
+  std::atomic<int> order { 0 };
+  int writeOrder = -1, readOrder = -1, structuralOrder = -1;
+  std::atomic<int> independentOrder { -1 };
+
+  // Writes then reads IntManager, so runs in order. The sparse system does not conflict, so can run at any time.
+  uint32_t write = scheduler.AddSystem<Writes<IntManager>>("Write", [&]()
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    writeOrder = order++;
+  });
+  uint32_t independent = scheduler.AddSystem<Reads<IntSparseManager>, Writes<EvenFlags>>("Independent", [&]() { independentOrder = order++; });
+  uint32_t read = scheduler.AddSystem<Reads<IntManager>>("Read", [&]()
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    readOrder = order++;
+  });
+  uint32_t readFlags = scheduler.AddSystem<Reads<IntSparseManager, EvenFlags>>("ReadFlags", [&]() {});
+  uint32_t structural = scheduler.AddSystem<Structural>("Structural", [&]() { structuralOrder = order++; });
+
+  EXPECT_TRUE(scheduler.GetDependencies(write).empty());
+  EXPECT_TRUE(scheduler.GetDependencies(independent).empty());
+  EXPECT_EQ(std::vector<uint32_t>{ write }, scheduler.GetDependencies(read));
+  EXPECT_EQ(std::vector<uint32_t>{ independent }, scheduler.GetDependencies(readFlags));
+  EXPECT_EQ(4u, scheduler.GetDependencies(structural).size());
+  EXPECT_STREQ("Read", scheduler.GetSystemName(read));
+
+  JobSystem jobs(4);
+  for (int frame = 0; frame < 3; frame++)
+  {
+    order = 0;
+    scheduler.Run(jobs);
+    EXPECT_LT(writeOrder, readOrder);
+    EXPECT_NE(-1, independentOrder.load());
+    EXPECT_EQ(3, structuralOrder);
+
+    // The write then read chain is the longest
+    std::vector<uint32_t> criticalPath = scheduler.GetCriticalPath();
+    ASSERT_EQ(3u, criticalPath.size());
+    EXPECT_EQ(write, criticalPath[0]);
+    EXPECT_EQ(read, criticalPath[1]);
+    EXPECT_EQ(structural, criticalPath[2]);
+    EXPECT_GE(scheduler.GetCriticalPathTime(), 10.0);
+    EXPECT_GE(scheduler.GetFrameTime(), scheduler.GetCriticalPathTime());
+    EXPECT_GE(scheduler.GetSystemTime(write), 5.0);
+  }
+}
+
+TEST(CreateTest, Query)
+{
+  auto context = Context<TestGroup>();
+  std::vector<GroupID> groups;
+  std::vector<std::vector<EntityID>> entities(4);
+  for (int g = 0; g < 4; g++)
+  {
+    groups.push_back(context.AddEntityGroup());
+    entities[g].resize(3000);
+    context.AddEntities(groups[g], 3000, entities[g].data());
+    for (int i = g; i < 3000; i += 2)
+    {
+      context.AddComponent<IntManager>(entities[g][i], i);
+      context.AddComponent<IntSparseManager>(entities[g][i], i);
+      context.SetFlag<EvenFlags>(entities[g][i], (i % 4) < 2);
+    }
+  }
+
+  // Matches the same entities and components as IterEntity
+  auto checkQuery = [&context](auto& io_query, auto i_iter)
+  {
+    std::vector<EntityID> expected;
+    for (auto& i : i_iter)
+    {
+      expected.push_back(i.GetEntityID());
+    }
+    std::vector<EntityID> found;
+    for (auto& i : io_query.Iter(context))
+    {
+      EXPECT_EQ((int)i.GetEntityID().m_subID, *i);
+      found.push_back(i.GetEntityID());
+    }
+    EXPECT_EQ(expected, found);
+    EXPECT_EQ((uint32_t)expected.size(), io_query.GetCount(context));
+  };
+
+  Query<IntManager, EvenFlags> query;
+  Query<IntSparseManager, EvenFlags, IntManager> sparseQuery;
+  Query<FloatManager> emptyQuery;
+  checkQuery(query, IterEntity<IntManager, EvenFlags>(context));
+  checkQuery(sparseQuery, IterEntity<IntSparseManager, EvenFlags, IntManager>(context));
+  checkQuery(emptyQuery, IterEntity<FloatManager>(context));
+  EXPECT_EQ(4u, query.GetRebuildCount());
+
+  // No changes - nothing is rebuilt. Setting a flag to its current value is not a change.
+  context.SetFlag<EvenFlags>(entities[1][1], true);
+  checkQuery(query, IterEntity<IntManager, EvenFlags>(context));
+  EXPECT_EQ(4u, query.GetRebuildCount());
+
+  // Only changed groups are rebuilt
+  context.SetFlag<EvenFlags>(entities[1][3], true);
+  checkQuery(query, IterEntity<IntManager, EvenFlags>(context));
+  EXPECT_EQ(5u, query.GetRebuildCount());
+
+  context.RemoveComponent<IntManager>(entities[2][100]);
+  context.RemoveEntity(entities[3][101]);
+  int value = 101;
+  context.AddComponent<IntManager>(entities[0][101], value);
+  checkQuery(query, IterEntity<IntManager, EvenFlags>(context));
+  checkQuery(sparseQuery, IterEntity<IntSparseManager, EvenFlags, IntManager>(context));
+  EXPECT_EQ(8u, query.GetRebuildCount());
+
+  // Removing entities without the component or flag is not a change
+  EntityID noFlagIDs[] = { entities[0][1], entities[0][3] };
+  context.RemoveEntities(noFlagIDs, 2);
+  checkQuery(query, IterEntity<IntManager, EvenFlags>(context));
+  EXPECT_EQ(8u, query.GetRebuildCount());
+
+  // Removed and re-added groups
+  context.RemoveEntityGroup(groups[1]);
+  checkQuery(query, IterEntity<IntManager, EvenFlags>(context));
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> newEntities(100);
+  context.AddEntities(group, 100, newEntities.data());
+  checkQuery(query, IterEntity<IntManager, EvenFlags>(context));
+  value = 10;
+  context.AddComponent<IntManager>(newEntities[10], value);
+  context.SetFlag<EvenFlags>(newEntities[10], true);
+  checkQuery(query, IterEntity<IntManager, EvenFlags>(context));
+}
+
+TEST(CreateTest, MultiFilterIteration)
+{
+  // IntersectBits64 matches a scalar AND for all counts (SIMD body and remainder)
+  for (uint32_t count = 0; count < 12; count++)
+  {
+    std::vector<uint64_t> a(count), b(count), c(count), dest(count, 0);
+    std::vector<uint64_t> expected(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+      a[i] = 0xF0F0F0F0F0F0F0F0ull ^ (uint64_t(i) << 40);
+      b[i] = 0xFF00FF00FF00FF00ull + i;
+      c[i] = (i == 5) ? 0 : ~uint64_t(i);
+      expected[i] = a[i] & b[i] & c[i];
+    }
+    const uint64_t* sources[] = { a.data(), b.data(), c.data() };
+    EXPECT_EQ(count > 0, IntersectBits64(dest.data(), sources, count));
+    EXPECT_EQ(expected, dest);
+
+    std::vector<uint64_t> zero(count, 0);
+    const uint64_t* zeroSources[] = { a.data(), zero.data() };
+    EXPECT_FALSE(IntersectBits64(dest.data(), zeroSources, count));
+    EXPECT_EQ(zero, dest);
+  }
+
+  // Four filters over several mask blocks, with a partial last block, in all groups and a single group
+  auto context = Context<TestGroup>();
+  GroupID emptyGroup = context.AddEntityGroup();
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(2000);
+  context.AddEntities(group, 2000, entities.data());
+  for (int i = 0; i < 2000; i++)
+  {
+    if ((i % 3) != 0)
+    {
+      context.AddComponent<IntManager>(entities[i], i);
+    }
+    if ((i % 5) != 0 || i > 1500)
+    {
+      context.AddComponent<FloatManager>(entities[i]);
+    }
+    context.SetFlag<TestFlagManager>(entities[i], (i % 7) != 0);
+    context.SetFlag<EvenFlags>(entities[i], (i % 2) == 0);
+    context.SetFlag<TestFlagManager2>(entities[i], (i < 600) || (i > 1100));
+  }
+
+  std::vector<int> expected;
+  for (int i = 0; i < 2000; i++)
+  {
+    if ((i % 3) != 0 && ((i % 5) != 0 || i > 1500) && (i % 7) != 0 && (i % 2) == 0 && ((i < 600) || (i > 1100)))
+    {
+      expected.push_back(i);
+    }
+  }
+
+  std::vector<int> found;
+  for (auto& i : IterEntity<IntManager, FloatManager, TestFlagManager, EvenFlags, TestFlagManager2>(context))
+  {
+    EXPECT_EQ(group, i.GetEntityID().m_groupID);
+    EXPECT_EQ((int)i.GetEntityID().m_subID, *i);
+    found.push_back(*i);
+  }
+  EXPECT_EQ(expected, found);
+
+  found.clear();
+  for (auto& i : IterEntity<IntManager, FloatManager, TestFlagManager, EvenFlags, TestFlagManager2>(context, group))
+  {
+    found.push_back(*i);
+  }
+  EXPECT_EQ(expected, found);
+
+  int count = 0;
+  for (auto& i : IterEntity<IntManager, FloatManager, TestFlagManager, EvenFlags, TestFlagManager2>(context, emptyGroup))
+  {
+    count++;
+  }
+  EXPECT_EQ(0, count);
+}
+
+TEST(CreateTest, WithoutOptionalIteration)
+{
+  // IntersectBits64 with exclusions matches a scalar AND-NOT for all counts (SIMD body and remainder)
+  for (uint32_t count = 0; count < 12; count++)
+  {
+    std::vector<uint64_t> a(count), b(count), c(count), dest(count, 0);
+    std::vector<uint64_t> expected(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+      a[i] = 0xF0F0F0F0F0F0F0F0ull ^ (uint64_t(i) << 40);
+      b[i] = 0xFF00FF00FF00FF00ull + i;
+      c[i] = (i == 5) ? ~uint64_t(0) : uint64_t(i) << 60;
+      expected[i] = a[i] & ~b[i] & ~c[i];
+    }
+    const uint64_t* sources[] = { a.data() };
+    const uint64_t* excludes[] = { b.data(), c.data() };
+    EXPECT_EQ(count > 0, (IntersectBits64<1, 2>(dest.data(), sources, excludes, count)));
+    EXPECT_EQ(expected, dest);
+  }
+
+  // Entities with IntManager and EvenFlags, without FloatManager or TestFlagManager, with optional IntSparseManager/IntIDManager
+  auto context = Context<TestGroup>();
+  GroupID emptyGroup = context.AddEntityGroup();
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(2000);
+  context.AddEntities(group, 2000, entities.data());
+  for (int i = 0; i < 2000; i++)
+  {
+    if ((i % 3) != 0)
+    {
+      context.AddComponent<IntManager>(entities[i], i);
+    }
+    if ((i % 5) == 0 && i < 1500)
+    {
+      context.AddComponent<FloatManager>(entities[i]);
+    }
+    if ((i % 11) == 0)
+    {
+      int value = i * 2;
+      context.AddComponent<IntSparseManager>(entities[i], value);
+    }
+    if ((i % 4) == 0)
+    {
+      int value = i * 3;
+      context.AddComponent<IntIDManager>(entities[i], value);
+    }
+    context.SetFlag<TestFlagManager>(entities[i], (i > 600) && (i < 1100));
+    context.SetFlag<EvenFlags>(entities[i], (i % 2) == 0);
+  }
+
+  std::vector<int> expected;
+  int expectedSparse = 0;
+  int expectedID = 0;
+  for (int i = 0; i < 2000; i++)
+  {
+    if ((i % 3) != 0 && (i % 2) == 0 && !((i % 5) == 0 && i < 1500) && !((i > 600) && (i < 1100)))
+    {
+      expected.push_back(i);
+      expectedSparse += ((i % 11) == 0) ? 1 : 0;
+      expectedID += ((i % 4) == 0) ? 1 : 0;
+    }
+  }
+
+  std::vector<int> found;
+  int foundSparse = 0;
+  int foundID = 0;
+  for (auto& i : IterEntity<IntManager, Without<FloatManager>, EvenFlags, Optional<IntSparseManager>, Without<TestFlagManager>, Optional<IntIDManager>>(context))
+  {
+    EXPECT_EQ(group, i.GetEntityID().m_groupID);
+    EXPECT_EQ((int)i.GetEntityID().m_subID, *i);
+    found.push_back(*i);
+
+    IntSparseManager::Component sparse;
+    EXPECT_EQ(context.HasComponent<IntSparseManager>(i.GetEntityID()), i.GetOptional<IntSparseManager>(sparse));
+    if (context.HasComponent<IntSparseManager>(i.GetEntityID()))
+    {
+      EXPECT_EQ(*i * 2, *sparse);
+      foundSparse++;
+    }
+
+    IntIDManager::Component id;
+    EXPECT_EQ(context.HasComponent<IntIDManager>(i.GetEntityID()), i.GetOptional<IntIDManager>(id));
+    if (context.HasComponent<IntIDManager>(i.GetEntityID()))
+    {
+      EXPECT_EQ(*i * 3, *id);
+      EXPECT_EQ(i.GetEntityID().m_subID, id.GetSubID());
+      foundID++;
+    }
+  }
+  EXPECT_EQ(expected, found);
+  EXPECT_EQ(expectedSparse, foundSparse);
+  EXPECT_EQ(expectedID, foundID);
+
+  found.clear();
+  foundID = 0;
+  for (auto& i : IterEntity<IntManager, Without<FloatManager>, Without<TestFlagManager>, EvenFlags, Optional<IntIDManager>>(context, group))
+  {
+    found.push_back(*i);
+    IntIDManager::Component id;
+    if (i.GetOptional<IntIDManager>(id))
+    {
+      EXPECT_EQ(*i * 3, *id);
+      foundID++;
+    }
+  }
+  EXPECT_EQ(expected, found);
+  EXPECT_EQ(expectedID, foundID);
+
+  // Only optional filters stop at every entity with the component
+  int count = 0;
+  for (auto& i : IterEntity<IntManager, Optional<IntIDManager>>(context))
+  {
+    count++;
+  }
+  EXPECT_EQ(context.GetGroup(group)->intManager.GetComponentCount(), (ECSIndex)count);
+
+  count = 0;
+  for (auto& i : IterEntity<IntManager, Without<EvenFlags>>(context, emptyGroup))
+  {
+    count++;
+  }
+  EXPECT_EQ(0, count);
+}
+
+TEST(CreateTest, JoinIteration)
+{
+  // Entities with IntManager, FloatManager, IntIDManager and IntSparseManager on different patterns, and a flag filter
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  GroupID group2 = context.AddEntityGroup();
+  std::vector<EntityID> entities(2000);
+  context.AddEntities(group, 1000, entities.data());
+  context.AddEntities(group2, 1000, entities.data() + 1000);
+  for (int i = 0; i < 2000; i++)
+  {
+    if ((i % 3) != 0)
+    {
+      context.AddComponent<IntManager>(entities[i], i);
+    }
+    if ((i % 5) != 0)
+    {
+      float value = float(i) * 0.5f;
+      context.AddComponent<FloatManager>(entities[i], value);
+    }
+    if ((i % 2) == 0 || i > 1500)
+    {
+      int value = i * 3;
+      context.AddComponent<IntIDManager>(entities[i], value);
+    }
+    if ((i % 7) != 0)
+    {
+      int value = i * 2;
+      context.AddComponent<IntSparseManager>(entities[i], value);
+    }
+    context.SetFlag<TestFlagManager>(entities[i], (i < 300) || (i > 700));
+  }
+
+  std::vector<int> expected;
+  for (int i = 0; i < 2000; i++)
+  {
+    if ((i % 3) != 0 && (i % 5) != 0 && ((i % 2) == 0 || i > 1500) && (i % 7) != 0 && ((i < 300) || (i > 700)))
+    {
+      expected.push_back(i);
+    }
+  }
+
+  // Each joined accessor matches the component looked up from the entity
+  std::vector<int> found;
+  for (auto& i : IterEntity<IntManager, FloatManager, TestFlagManager, IntIDManager, IntSparseManager>(context))
+  {
+    EntityID id = i.GetEntityID();
+    EXPECT_EQ(*i, *i.GetComponent<IntManager>());
+    EXPECT_EQ(context.GetComponent<FloatManager>(id).m_index, i.GetComponent<FloatManager>().m_index);
+    EXPECT_EQ(float(*i) * 0.5f, *i.GetComponent<FloatManager>());
+    EXPECT_EQ(*i * 3, *i.GetComponent<IntIDManager>());
+    EXPECT_EQ(id.m_subID, i.GetComponent<IntIDManager>().GetSubID());
+    EXPECT_EQ(*i * 2, *i.GetComponent<IntSparseManager>());
+    found.push_back(*i);
+  }
+  EXPECT_EQ(expected, found);
+
+  // Accessing only some entities (skipping bit data items and moving between groups) gives the same components
+  uint32_t count = 0;
+  for (auto& i : IterEntity<IntManager, FloatManager, TestFlagManager, IntIDManager, IntSparseManager>(context))
+  {
+    if ((count++ % 37) == 0)
+    {
+      EXPECT_EQ(context.GetComponent<FloatManager>(i.GetEntityID()).m_index, i.GetComponent<FloatManager>().m_index);
+      EXPECT_EQ(*i * 2, *i.GetComponent<IntSparseManager>());
+    }
+  }
+  EXPECT_EQ(expected.size(), count);
+
+  // Joined accessors write the component data, and skip Without<>/Optional<> filters
+  for (auto& i : IterEntity<IntManager, Without<EvenFlags>, FloatManager, Optional<IntIDManager>>(context, group2))
+  {
+    *i.GetComponent<FloatManager>() = -1.0f;
+  }
+  for (int i = 0; i < 2000; i++)
+  {
+    if (context.HasComponent<FloatManager>(entities[i]))
+    {
+      bool written = (i >= 1000) && (i % 3) != 0;
+      EXPECT_EQ(written ? -1.0f : float(i) * 0.5f, *context.GetComponent<FloatManager>(entities[i]));
+    }
+  }
+}
+
+TEST(CreateTest, FlagIteration)
+{
+  // Flags on a few patterns over several mask blocks, in two groups with a removed group between them
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  GroupID removedGroup = context.AddEntityGroup();
+  GroupID group2 = context.AddEntityGroup();
+  context.RemoveEntityGroup(removedGroup);
+
+  std::vector<EntityID> entities(3000);
+  context.AddEntities(group, 2000, entities.data());
+  context.AddEntities(group2, 1000, entities.data() + 2000);
+  for (int i = 0; i < 3000; i++)
+  {
+    context.SetFlag<EvenFlags>(entities[i], (i % 2) == 0);
+    context.SetFlag<TestFlagManager>(entities[i], (i == 5) || (i == 1999) || (i > 1300 && i < 1310) || (i == 2700));
+    context.SetFlag<TestFlagManager2>(entities[i], (i % 3) == 0);
+    if ((i % 5) != 0)
+    {
+      context.AddComponent<IntManager>(entities[i], i);
+    }
+  }
+
+  std::vector<EntityID> expected;
+  std::vector<EntityID> found;
+  for (int i = 0; i < 3000; i++)
+  {
+    if ((i == 5) || (i == 1999) || (i > 1300 && i < 1310) || (i == 2700))
+    {
+      expected.push_back(entities[i]);
+    }
+  }
+  for (auto& i : IterFlags<TestFlagManager>(context))
+  {
+    found.push_back(i.GetEntityID());
+  }
+  EXPECT_EQ(expected, found);
+
+  // Flag only in one group, and a flag that is never set
+  int count = 0;
+  for (auto& i : IterFlags<EvenFlags>(context, group2))
+  {
+    EXPECT_EQ(group2, i.GetEntityID().m_groupID);
+    EXPECT_EQ(0u, ((ECSIndex)i.GetEntityID().m_subID) % 2);
+    count++;
+  }
+  EXPECT_EQ(500, count);
+
+  count = 0;
+  for (auto& i : IterFlags<FalseFlags>(context))
+  {
+    count++;
+  }
+  EXPECT_EQ(0, count);
+
+  // Flag, then components and filters
+  std::vector<int> expectedValues;
+  std::vector<int> foundValues;
+  for (int i = 0; i < 3000; i++)
+  {
+    if ((i % 2) == 0 && (i % 5) != 0 && (i % 3) != 0)
+    {
+      expectedValues.push_back(i);
+    }
+  }
+  for (auto& i : IterFlags<EvenFlags, IntManager, Without<TestFlagManager2>, Optional<FloatManager>>(context))
+  {
+    EXPECT_EQ(context.GetComponent<IntManager>(i.GetEntityID()).m_index, i.GetComponent<IntManager>().m_index);
+    foundValues.push_back(*i.GetComponent<IntManager>());
+    FloatManager::Component f;
+    EXPECT_FALSE(i.GetOptional<FloatManager>(f));
+  }
+  EXPECT_EQ(expectedValues, foundValues);
+
+  foundValues.clear();
+  for (auto& i : IterFlags<EvenFlags, IntManager, Without<TestFlagManager2>>(context, group))
+  {
+    foundValues.push_back(*i.GetComponent<IntManager>());
+  }
+  expectedValues.erase(std::remove_if(expectedValues.begin(), expectedValues.end(), [](int v) { return v >= 2000; }), expectedValues.end());
+  EXPECT_EQ(expectedValues, foundValues);
+}
+
+TEST(CreateTest, ArenaGroup)
+{
+  auto context = Context<ArenaGroup>();
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(2000);
+  context.AddEntities(group, 2000, entities.data());
+
+  for (int i = 0; i < 2000; i++)
+  {
+    context.AddComponent<ArenaIntManager>(entities[i], i);
+    if ((i % 2) == 0)
+    {
+      context.AddComponent<ArenaIntIDManager>(entities[i], i);
+    }
+  }
+  for (int i = 0; i < 2000; i += 3)
+  {
+    context.RemoveComponent<ArenaIntManager>(entities[i]);
+  }
+
+  // All component data is allocated from the group arena
+  const ArenaGroup& arenaGroup = *context.GetGroup(group);
+  EXPECT_GT(arenaGroup.arena.GetAllocatedSize(), 2000 * sizeof(int));
+  EXPECT_GT(arenaGroup.arena.GetChunkCount(), 0u);
+
+  int count = 0;
+  for (auto& v : IterEntity<ArenaIntManager, ArenaIntIDManager>(context))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    EXPECT_EQ(*v, *context.GetComponent<ArenaIntIDManager>(v.GetEntityID()));
+    count++;
+  }
+  EXPECT_EQ(666, count);
+
+  // Removing the group frees all the data with the arena
+  context.RemoveEntityGroup(group);
+  EXPECT_FALSE(context.IsValid(group));
+}
+
+void TestSummaryBits(const ComponentManager& i_manager)
+{
+  const std::vector<uint64_t>& bits = i_manager.GetBits();
+  const std::vector<uint64_t>& summary = i_manager.GetSummaryBits();
+  EXPECT_EQ((bits.size() + 63) / 64, summary.size());
+  for (uint32_t i = 0; i < bits.size(); i++)
+  {
+    bool summaryBit = (summary[i >> 6] & (uint64_t(1) << (i & 0x3F))) != 0;
+    EXPECT_EQ(bits[i] != 0, summaryBit);
+  }
+}
+
+TEST(CreateTest, SparseIteration)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  std::vector<EntityID> entities(20000);
+  context.AddEntities(group, 20000, entities.data());
+
+  // Add components to a few entities spread across blocks
+  const std::vector<int> ids = { 5, 4100, 4101, 4160, 15000, 19999 };
+  for (int i : ids)
+  {
+    context.AddComponent<IntManager>(entities[i], i);
+  }
+  for (int i : { 4101, 19999 })
+  {
+    context.AddComponent<IntIDManager>(entities[i], i);
+  }
+
+  const TestGroup& testGroup = *context.GetGroup(group);
+  TestSummaryBits(testGroup.intManager);
+  TestSummaryBits(testGroup.intIDManager);
+  EXPECT_EQ(4100u / 64, testGroup.intManager.FindNextBits(1));
+  EXPECT_EQ(4160u / 64, testGroup.intManager.FindNextBits(4100 / 64 + 1));
+  EXPECT_EQ(15000u / 64, testGroup.intManager.FindNextBits(4160 / 64 + 1));
+  EXPECT_EQ(testGroup.intManager.GetBits().size(), testGroup.intManager.FindNextBits(19999 / 64 + 1));
+
+  std::vector<int> found;
+  for (auto& v : IterEntity<IntManager>(context, group))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    found.push_back(*v);
+  }
+  EXPECT_EQ(ids, found);
+
+  found.clear();
+  for (auto& v : IterEntity<IntManager, IntIDManager>(context))
+  {
+    EXPECT_EQ((int)v.GetEntityID().m_subID, *v);
+    found.push_back(*v);
+  }
+  EXPECT_EQ(std::vector<int>({ 4101, 19999 }), found);
+
+  // Emptying a bit data item must clear its summary bit
+  context.RemoveComponent<IntManager>(entities[4160]);
+  context.RemoveEntity(entities[5]);
+  EntityID removeIDs[] = { entities[4100], entities[4101] };
+  context.RemoveEntities(removeIDs, 2);
+  TestSummaryBits(testGroup.intManager);
+  TestSummaryBits(testGroup.intIDManager);
+
+  found.clear();
+  for (auto& v : IterEntity<IntManager>(context, group))
+  {
+    found.push_back(*v);
+  }
+  EXPECT_EQ(std::vector<int>({ 15000, 19999 }), found);
+}
+
+// Debug only tests
+#ifndef NDEBUG
+
+// Too slow to exhaust 32 bit ids
+#if !defined(AT_ECS_32BIT_IDS)
+TEST(DebugFailuresDeathTest, TooManyGroups)
+{
+  auto context = Context<TestGroup>();
+  context.ReserveGroups(ECSIndex_Max);
+
+  for (uint32_t i = 0; i < ECSIndex_Max; i++)
+  {
+    context.AddEntityGroup();
+  }
+
+  EXPECT_DEATH(context.AddEntityGroup(), "Assertion failed");
+}
+
+TEST(DebugFailuresDeathTest, TooManyEntities)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  context.ReserveEntities(group, ECSIndex_Max);
+
+  for (uint32_t i = 0; i < ECSIndex_Max; i++)
+  {
+    context.AddEntity(group);
+  }
+
+  EXPECT_DEATH(context.AddEntity(group), "Assertion failed");
+}
+#endif
+
+TEST(DebugFailuresDeathTest, DelGroups)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.RemoveEntityGroup((GroupID)0), "Assertion failed");
+}
+
+TEST(DebugFailuresDeathTest, InvalidID)
+{
+  auto context = Context<TestGroup>();
+
+  // Check invalid ID
+  EXPECT_DEATH(context.AddComponent<FloatManager>(EntityID_None), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidGroup)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.AddEntity((GroupID)0), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidEntityRemove)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.RemoveEntity(EntityID_None), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidEntity2Remove)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+
+  EXPECT_DEATH(context.RemoveEntity(EntityID{ group , (EntitySubID)0}), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidHasComponent)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.HasComponent<FloatManager>(EntityID_None), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidGetComponentBadEntity)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.GetComponent<FloatManager>(EntityID_None), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidGetComponentNoComponent)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  EntityID entity = context.AddEntity(group);
+
+  EXPECT_DEATH(context.GetComponent<FloatManager>(entity), "Assertion failed");
+}
+
+TEST(DebugFailuresDeathTest, InvalidAddComponentBadEntity)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.AddComponent<FloatManager>(EntityID_None), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, DuplicateCreate)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  EntityID entity = context.AddEntity(group);
+
+  context.AddComponent<FloatManager>(entity);
+
+  EXPECT_DEATH(context.AddComponent<FloatManager>(entity), "Assertion failed");
+}
+
+TEST(DebugFailuresDeathTest, InvalidRemoveComponentBadEntity)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.RemoveComponent<FloatManager>(EntityID_None), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidRemove)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  EntityID entity = context.AddEntity(group);
+
+  EXPECT_DEATH(context.RemoveComponent<FloatManager>(entity), "Assertion failed");
+}
+
+TEST(DebugFailuresDeathTest, DuplicateRemove)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  EntityID entity = context.AddEntity(group);
+
+  context.AddComponent<FloatManager>(entity);
+  context.RemoveComponent<FloatManager>(entity);
+
+  EXPECT_DEATH(context.RemoveComponent<FloatManager>(entity), "Assertion failed");
+}
+
+TEST(DebugFailuresDeathTest, InvalidGetGroup)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.GetGroup(EntityID_None), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidHasFlag)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.HasFlag<TestFlagManager>(EntityID_None), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidSetFlag)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.SetFlag<TestFlagManager>(EntityID_None, true), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidReserveEntities)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.ReserveEntities(EntityID_None.m_groupID, 10), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, InvalidReserveComponent)
+{
+  auto context = Context<TestGroup>();
+
+  EXPECT_DEATH(context.ReserveComponent<FloatManager>(EntityID_None.m_groupID, 10), "IsValid");
+}
+
+TEST(DebugFailuresDeathTest, HoldReference)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  EntityID entity = context.AddEntity(group);
+
+  auto newItem = context.AddComponent<FloatManager>(entity);
+
+  EntityID entity2 = context.AddEntity(group);
+
+  // Check that adding a component on the group fails while holding a reference
+  EXPECT_DEATH(context.AddComponent<FloatManager>(entity2), "Assertion failed");
+}
+
+TEST(DebugFailuresDeathTest, DelHoldReference)
 {
   auto context = Context<TestGroup>();
   GroupID group = context.AddEntityGroup();
@@ -1354,4 +2996,46 @@ TEST(DebugFailuresDeathTest, AddToDeletedFlag)
   EXPECT_DEATH(context.SetFlag<TestFlagManager>(entity, true), "Assertion failed");
 }
 
+TEST(DebugFailuresDeathTest, AddComponentsMaskToDeleted)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  EntityID entities[3];
+  context.AddEntities(group, 3, entities);
+  context.RemoveEntity(entities[1]);
+
+  // Check that a mask containing deleted or uncreated entities fails
+  uint64_t deletedMask[] = { 0x7 };
+  EXPECT_DEATH(context.AddComponents<FloatManager>(group, deletedMask), "Assertion failed");
+  uint64_t uncreatedMask[] = { 0x9 };
+  EXPECT_DEATH(context.AddComponents<FloatManager>(group, uncreatedMask), "Assertion failed");
+}
+
+TEST(DebugFailuresDeathTest, CommandBufferAddToDeleted)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  EntityID entity = context.AddEntity(group);
+  context.RemoveEntity(entity);
+
+  // Check that flushing an add to a deleted entity fails
+  CommandBuffer<TestGroup> commands;
+  commands.AddComponent<FloatManager>(entity);
+  EXPECT_DEATH(commands.Flush(context), "Assertion failed");
+}
+
+TEST(DebugFailuresDeathTest, CommandBufferAddAndRemove)
+{
+  auto context = Context<TestGroup>();
+  GroupID group = context.AddEntityGroup();
+  EntityID entity = context.AddEntity(group);
+  context.AddComponent<FloatManager>(entity);
+
+  // Check that adding and removing the same component in one buffer fails
+  CommandBuffer<TestGroup> commands;
+  commands.AddComponent<FloatManager>(entity);
+  commands.RemoveComponent<FloatManager>(entity);
+  EXPECT_DEATH(commands.Flush(context), "Assertion failed");
+}
+
 #endif 
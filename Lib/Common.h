@@ -3,6 +3,10 @@
 #include <cstdint>
 #include <cassert>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #ifndef NDEBUG
 
 #define AT_ASSERT(x) assert(x)
@@ -36,9 +40,22 @@ public:
 #endif
 
 
-/// \brief Get the count of the number of bits set
+// Use the native population count instruction when the build targets a CPU that has it.
+// (MSVC only guarantees POPCNT with /arch:AVX or above, GCC/Clang define __POPCNT__ with -mpopcnt or -march)
+// Define AT_NO_NATIVE_POPCOUNT to force the software fallback.
+#if !defined(AT_NO_NATIVE_POPCOUNT)
+#if defined(_MSC_VER) && defined(_M_X64) && defined(__AVX__)
+#define AT_NATIVE_POPCOUNT 1
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+#define AT_NATIVE_POPCOUNT 1
+#elif defined(__GNUC__) && (defined(__POPCNT__) || defined(__aarch64__))
+#define AT_NATIVE_POPCOUNT 1
+#endif
+#endif
+
+/// \brief Get the count of the number of bits set, using only integer arithmetic
 /// Taken from https://en.wikipedia.org/wiki/Hamming_weight
-inline uint16_t PopCount64(uint64_t x)
+inline uint16_t PopCount64Software(uint64_t x)
 {
   const uint64_t m1 = 0x5555555555555555; //binary: 0101...
   const uint64_t m2 = 0x3333333333333333; //binary: 00110011..
@@ -51,3 +68,127 @@ inline uint16_t PopCount64(uint64_t x)
   return uint16_t((x * h01) >> 56);  //returns left 8 bits of x + (x<<8) + (x<<16) + (x<<24) + ... 
 }
 
+/// \brief Get the count of the number of bits set (using the native instruction if available)
+inline uint16_t PopCount64(uint64_t x)
+{
+#if defined(AT_NATIVE_POPCOUNT) && defined(_MSC_VER) && defined(_M_ARM64)
+  return uint16_t(_CountOneBits64(x));
+#elif defined(AT_NATIVE_POPCOUNT) && defined(_MSC_VER)
+  return uint16_t(__popcnt64(x));
+#elif defined(AT_NATIVE_POPCOUNT)
+  return uint16_t(__builtin_popcountll(x));
+#else
+  return PopCount64Software(x);
+#endif
+}
+
+/// \brief Get the index of the lowest set bit (using the hardware bit scan instruction)
+/// \param x The value to scan (must not be 0)
+inline uint32_t CountTrailingZeros64(uint64_t x)
+{
+  AT_ASSERT(x != 0);
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return index;
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if (_BitScanForward(&index, (unsigned long)x))
+  {
+    return index;
+  }
+  _BitScanForward(&index, (unsigned long)(x >> 32));
+  return index + 32;
+#else
+  return (uint32_t)__builtin_ctzll(x);
+#endif
+}
+
+// Use SIMD instructions to intersect bit arrays when the build targets a CPU that has them.
+// (AVX2 with /arch:AVX2 on MSVC or -mavx2/-march on GCC/Clang, SSE2 is always available on x64)
+// Define AT_NO_SIMD_BITS to force the scalar fallback.
+#if !defined(AT_NO_SIMD_BITS)
+#if defined(__AVX2__)
+#define AT_SIMD_BITS_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define AT_SIMD_BITS_SSE2 1
+#include <emmintrin.h>
+#endif
+#endif
+
+/// \brief Intersect N bit arrays and remove the bits of M bit arrays
+///        (o_dest[i] = i_sources[0][i] & i_sources[1][i] & ... & ~i_excludes[0][i] & ~i_excludes[1][i] & ...), using SIMD instructions if available
+/// \param o_dest The destination bit array
+/// \param i_sources The N source bit arrays (N must be at least 1)
+/// \param i_excludes The M bit arrays of bits to remove (may be null if M is 0)
+/// \param i_count The count of 64 bit items
+/// \return Returns true if any destination bits are set
+template<uint32_t N, uint32_t M>
+inline bool IntersectBits64(uint64_t* o_dest, const uint64_t* const* i_sources, const uint64_t* const* i_excludes, uint32_t i_count)
+{
+  static_assert(N > 0, "At least one source is required");
+  uint32_t i = 0;
+  uint64_t any = 0;
+#if defined(AT_SIMD_BITS_AVX2)
+  __m256i anyBits = _mm256_setzero_si256();
+  for (; i + 4 <= i_count; i += 4)
+  {
+    __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(i_sources[0] + i));
+    for (uint32_t s = 1; s < N; s++)
+    {
+      bits = _mm256_and_si256(bits, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(i_sources[s] + i)));
+    }
+    for (uint32_t s = 0; s < M; s++)
+    {
+      bits = _mm256_andnot_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(i_excludes[s] + i)), bits);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(o_dest + i), bits);
+    anyBits = _mm256_or_si256(anyBits, bits);
+  }
+  any = uint64_t(!_mm256_testz_si256(anyBits, anyBits));
+#elif defined(AT_SIMD_BITS_SSE2)
+  __m128i anyBits = _mm_setzero_si128();
+  for (; i + 2 <= i_count; i += 2)
+  {
+    __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(i_sources[0] + i));
+    for (uint32_t s = 1; s < N; s++)
+    {
+      bits = _mm_and_si128(bits, _mm_loadu_si128(reinterpret_cast<const __m128i*>(i_sources[s] + i)));
+    }
+    for (uint32_t s = 0; s < M; s++)
+    {
+      bits = _mm_andnot_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(i_excludes[s] + i)), bits);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(o_dest + i), bits);
+    anyBits = _mm_or_si128(anyBits, bits);
+  }
+  any = uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(anyBits, _mm_setzero_si128())) != 0xFFFF);
+#endif
+  for (; i < i_count; i++)
+  {
+    uint64_t bits = i_sources[0][i];
+    for (uint32_t s = 1; s < N; s++)
+    {
+      bits &= i_sources[s][i];
+    }
+    for (uint32_t s = 0; s < M; s++)
+    {
+      bits &= ~i_excludes[s][i];
+    }
+    o_dest[i] = bits;
+    any |= bits;
+  }
+  return any != 0;
+}
+
+/// \brief Intersect N bit arrays (o_dest[i] = i_sources[0][i] & i_sources[1][i] & ...), using SIMD instructions if available
+/// \param o_dest The destination bit array
+/// \param i_sources The source bit arrays
+/// \param i_count The count of 64 bit items
+/// \return Returns true if any destination bits are set
+template<uint32_t N>
+inline bool IntersectBits64(uint64_t* o_dest, const uint64_t* const (&i_sources)[N], uint32_t i_count)
+{
+  return IntersectBits64<N, 0>(o_dest, i_sources, nullptr, i_count);
+}
@@ -1,38 +1,62 @@
 #include "ECS.h"
 #include <algorithm>
 
-namespace
+std::atomic<uint64_t> ComponentFlags::s_versionCounter { 0 };
+
+EntitySubID EntityGroupBase::PopDeletedEntity()
+{
+  AT_ASSERT(m_deletedCount > 0);
+
+  // Find the lowest deleted id (all items before the search start are empty)
+  uint32_t index = m_deletedSearchStart;
+  while (m_deletedBits[index] == 0)
+  {
+    index++;
+  }
+  m_deletedSearchStart = index;
+
+  uint64_t bits = m_deletedBits[index];
+  m_deletedBits[index] = bits & (bits - 1);
+  m_deletedCount--;
+  return (EntitySubID)((index << 6) + CountTrailingZeros64(bits));
+}
+
+void EntityGroupBase::PushDeletedEntity(EntitySubID i_entitySubID)
 {
-  inline bool DeletedSorter(EntitySubID a, EntitySubID b)
+  uint64_t mask = uint64_t(1) << ((ECSIndex)i_entitySubID & 0x3F);
+  ECSIndex index = (ECSIndex)i_entitySubID >> 6;
+
+  // Do not add if already deleted (catch double deletes)
+  if ((m_deletedBits[index] & mask) == 0)
   {
-    return (a > b);
+    m_deletedBits[index] |= mask;
+    m_deletedCount++;
+    m_deletedSearchStart = std::min(m_deletedSearchStart, (uint32_t)index);
   }
 }
 
 EntitySubID EntityGroup::AddEntity()
 {
   // First check if there is a entity id that can be re-used
-  if (m_deletedEntities.size() > 0)
+  if (m_deletedCount > 0)
   {
-    EntitySubID retID = m_deletedEntities.back();
-    m_deletedEntities.pop_back();
-    return retID;
+    return PopDeletedEntity();
   }
 
   // Check if the array sizes need to grow
-  AT_ASSERT(m_entityCount < UINT16_MAX);
+  AT_ASSERT(m_entityCount < ECSIndex_Max);
   if ((m_entityCount & 0x3F) == 0)
   {
     for (ComponentManager* c : m_managers)
     {
-      c->m_prevSum.push_back(c->m_componentCount);
-      c->m_bitData.push_back(0);
+      c->AddBitData();
     }
 
     for (FlagManager* f : m_flagManagers)
     {
       f->m_bitData.push_back(0);
     }
+    m_deletedBits.push_back(0);
   }
 
   EntitySubID retID = (EntitySubID)m_entityCount;
@@ -40,14 +64,50 @@ EntitySubID EntityGroup::AddEntity()
   return retID;
 }
 
+void EntityGroup::AddEntities(GroupID i_groupID, ECSIndex i_count, EntityID* o_entities)
+{
+  // Re-use deleted entity ids first (pulled out in ascending order)
+  ECSIndex count = 0;
+  while (count < i_count && m_deletedCount > 0)
+  {
+    o_entities[count++] = EntityID{ i_groupID, PopDeletedEntity() };
+  }
+
+  ECSIndex newCount = i_count - count;
+  if (newCount == 0)
+  {
+    return;
+  }
+
+  // Grow all the arrays once
+  AT_ASSERT(uint64_t(m_entityCount) + newCount <= ECSIndex_Max);
+  uint32_t bitDataCount = (uint32_t(m_entityCount) + newCount + 63) >> 6;
+  for (ComponentManager* c : m_managers)
+  {
+    c->ResizeBitData(bitDataCount);
+  }
+
+  for (FlagManager* f : m_flagManagers)
+  {
+    f->m_bitData.resize(bitDataCount, 0);
+  }
+  m_deletedBits.resize(bitDataCount, 0);
+
+  for (; count < i_count; count++)
+  {
+    o_entities[count] = EntityID{ i_groupID, (EntitySubID)m_entityCount };
+    m_entityCount++;
+  }
+}
+
 void EntityGroup::RemoveEntity(GroupID i_groupID, EntitySubID i_entitySubID)
 {
   AT_ASSERT(IsValid(i_entitySubID));
 
-  uint64_t mask = uint64_t(1) << ((uint16_t)i_entitySubID & 0x3F);
+  uint64_t mask = uint64_t(1) << ((ECSIndex)i_entitySubID & 0x3F);
   uint64_t invMask = ~mask;
   uint64_t preBitsMask = mask - 1;
-  uint16_t index = (uint16_t)i_entitySubID >> 6;
+  ECSIndex index = (ECSIndex)i_entitySubID >> 6;
 
   // Loop for all component managers and remove
   EntityID entityID{ i_groupID, i_entitySubID };
@@ -60,17 +120,16 @@ void EntityGroup::RemoveEntity(GroupID i_groupID, EntitySubID i_entitySubID)
       // Debug check that there are no active accessors to the data
       c->m_accessCheck.CheckLock();
 
-      uint16_t offset = c->m_prevSum[index] + PopCount64(testBits & preBitsMask);
+      ECSIndex offset = c->GetPrevSum(index) + PopCount64(testBits & preBitsMask);
       c->OnComponentRemove(entityID, offset);
       
       c->m_bitData[index] = newBits;
+      c->UpdateSummary(index);
+      c->UpdateVersion();
 
       // Update the counts
       c->m_componentCount--;
-      for (uint32_t i = uint32_t(index) + 1; i < c->m_prevSum.size(); i++)
-      {
-        c->m_prevSum[i]--;
-      }
+      c->UpdatePrevSum(index, -1);
     }
   }
 
@@ -82,27 +141,80 @@ void EntityGroup::RemoveEntity(GroupID i_groupID, EntitySubID i_entitySubID)
     if (testBits != newBits)
     {
       f->m_bitData[index] = newBits;
+      f->UpdateVersion();
+    }
+  }
+
+  // Add to the deleted entities
+  PushDeletedEntity(i_entitySubID);
+}
+
+void EntityGroup::RemoveEntities(GroupID i_groupID, const EntitySubID* i_entitySubIDs, ECSIndex i_count)
+{
+  std::vector<EntitySubID> subIDs;
+  std::vector<EntityID> entities;
+  std::vector<ECSIndex> indices;
+
+  // Loop for all component managers and remove all components in one batch
+  for (ComponentManager* c : m_managers)
+  {
+    subIDs.clear();
+    entities.clear();
+    for (ECSIndex i = 0; i < i_count; i++)
+    {
+      AT_ASSERT(IsValid(i_entitySubIDs[i]));
+      if (c->HasComponent(i_entitySubIDs[i]))
+      {
+        subIDs.push_back(i_entitySubIDs[i]);
+        entities.push_back(EntityID{ i_groupID, i_entitySubIDs[i] });
+      }
+    }
+
+    if (subIDs.size() > 0)
+    {
+      // Debug check that there are no active accessors to the data
+      c->m_accessCheck.CheckLock();
+
+      indices.resize(subIDs.size());
+      c->ClearBits(subIDs.data(), (ECSIndex)subIDs.size(), indices.data());
+      c->OnComponentsRemove(entities.data(), indices.data(), (ECSIndex)subIDs.size());
     }
   }
 
-  // Add to the array of deleted entities
-  // Insert in reverse order so that they are pulled out sequentially
-  auto insertPos = std::lower_bound(m_deletedEntities.begin(), m_deletedEntities.end(), i_entitySubID, DeletedSorter);
+  // Loop for all flag managers and remove the bits
+  for (FlagManager* f : m_flagManagers)
+  {
+    uint64_t clearedBits = 0;
+    for (ECSIndex i = 0; i < i_count; i++)
+    {
+      uint64_t mask = uint64_t(1) << ((ECSIndex)i_entitySubIDs[i] & 0x3F);
+      ECSIndex index = (ECSIndex)i_entitySubIDs[i] >> 6;
+      clearedBits |= f->m_bitData[index] & mask;
+      f->m_bitData[index] &= ~mask;
+    }
+
+    // Only invalidate queries if a flag was actually removed
+    if (clearedBits != 0)
+    {
+      f->UpdateVersion();
+    }
+  }
 
-  // Do not insert if already in the list (catch double deletes)
-  if (insertPos == m_deletedEntities.end() ||
-      *insertPos != i_entitySubID)
+  // Add to the deleted entities
+  for (ECSIndex i = 0; i < i_count; i++)
   {
-    m_deletedEntities.insert(insertPos, i_entitySubID);
+    PushDeletedEntity(i_entitySubIDs[i]);
   }
 }
 
-bool EntityGroup::IsDeleted(EntitySubID i_entitySubID) const
+bool EntityGroupBase::IsDeleted(EntitySubID i_entitySubID) const
 {
-  return std::binary_search(m_deletedEntities.begin(), m_deletedEntities.end(), i_entitySubID, DeletedSorter);
+  uint64_t mask = uint64_t(1) << ((ECSIndex)i_entitySubID & 0x3F);
+  ECSIndex index = (ECSIndex)i_entitySubID >> 6;
+  return (m_deletedBits[index] & mask) != 0;
 }
 
-void EntityGroup::ReserveEntities(uint16_t i_count)
+void EntityGroup::ReserveEntities(ECSIndex i_count)
 {
   // Get how many entities to reserve (in multiples of 64)
   uint32_t existingReserve = ((uint32_t)m_entityCount + 63) >> 6;  
@@ -115,59 +227,282 @@ void EntityGroup::ReserveEntities(uint16_t i_count)
   // Reserve all the arrays
   for (ComponentManager* c : m_managers)
   {
-    c->m_bitData.reserve(reserveCount);
-    c->m_prevSum.reserve(reserveCount);
+    c->ReserveBitData(reserveCount);
   }
 
   for (FlagManager* f : m_flagManagers)
   {
     f->m_bitData.reserve(reserveCount);
   }
+  m_deletedBits.reserve(reserveCount);
 }
 
-uint16_t ComponentManager::SetBit(EntitySubID i_entitySubID)
+void EntityGroupBase::ResetEntities()
+{
+  m_entityCount = 0;
+  m_deletedBits.clear();
+  m_deletedCount = 0;
+  m_deletedSearchStart = 0;
+}
+
+void EntityGroup::Reset(GroupID i_groupID)
+{
+  std::vector<EntityID> entities;
+  std::vector<ECSIndex> indices;
+
+  // Remove all components from each manager in one batch (manager arrays keep their capacity)
+  for (ComponentManager* c : m_managers)
+  {
+    // Debug check that there are no active accessors to the data
+    c->m_accessCheck.CheckLock();
+
+    if (c->ClearAllBits(i_groupID, entities, indices))
+    {
+      c->OnComponentsRemove(entities.data(), indices.data(), (ECSIndex)indices.size());
+    }
+    c->ClearBitData();
+  }
+
+  for (FlagManager* f : m_flagManagers)
+  {
+    f->m_bitData.clear();
+    f->UpdateVersion();
+  }
+
+  ResetEntities();
+}
+
+ECSIndex ComponentManager::SetBit(EntitySubID i_entitySubID)
 {
   AT_ASSERT(!HasComponent(i_entitySubID));
 
-  uint64_t mask = uint64_t(1) << ((uint16_t)i_entitySubID & 0x3F);
+  uint64_t mask = uint64_t(1) << ((ECSIndex)i_entitySubID & 0x3F);
   uint64_t preBitsMask = mask - 1;
-  uint16_t index = (uint16_t)i_entitySubID >> 6;
+  ECSIndex index = (ECSIndex)i_entitySubID >> 6;
 
   uint64_t testBits = m_bitData[index];
   uint64_t newBits = testBits | mask;
-  uint16_t offset = m_prevSum[index] + PopCount64(testBits & preBitsMask);
+  ECSIndex offset = GetPrevSum(index) + PopCount64(testBits & preBitsMask);
 
   m_bitData[index] = newBits;
+  m_summary[index >> c_blockShift] |= uint64_t(1) << (index & c_blockMask);
+  UpdateVersion();
 
   // Update the counts
   m_componentCount++;
-  for (uint32_t i = uint32_t(index) + 1; i < m_prevSum.size(); i++)
-  {
-    m_prevSum[i]++;
-  }
+  UpdatePrevSum(index, 1);
   return offset;
 }
 
-uint16_t ComponentManager::ClearBit(EntitySubID i_entitySubID)
+ECSIndex ComponentManager::ClearBit(EntitySubID i_entitySubID)
 {
   AT_ASSERT(HasComponent(i_entitySubID) && m_componentCount > 0);
 
-  uint64_t mask = uint64_t(1) << ((uint16_t)i_entitySubID & 0x3F);
+  uint64_t mask = uint64_t(1) << ((ECSIndex)i_entitySubID & 0x3F);
   uint64_t preBitsMask = mask - 1;
-  uint16_t index = (uint16_t)i_entitySubID >> 6;
+  ECSIndex index = (ECSIndex)i_entitySubID >> 6;
 
   uint64_t testBits = m_bitData[index];
   uint64_t newBits = testBits & ~mask;
-  uint16_t offset = m_prevSum[index] + PopCount64(testBits & preBitsMask);
+  ECSIndex offset = GetPrevSum(index) + PopCount64(testBits & preBitsMask);
 
   m_bitData[index] = newBits;
+  UpdateSummary(index);
+  UpdateVersion();
 
   // Update the counts
   m_componentCount--;
-  for (uint32_t i = uint32_t(index) + 1; i < m_prevSum.size(); i++)
+  UpdatePrevSum(index, -1);
+  return offset;
+}
+
+void ComponentManager::SetBits(const EntitySubID* i_entitySubIDs, ECSIndex i_count, ECSIndex* o_indices)
+{
+  for (ECSIndex i = 0; i < i_count; i++)
   {
-    m_prevSum[i]--;
+    AT_ASSERT(!HasComponent(i_entitySubIDs[i]));
+    AT_ASSERT(i == 0 || i_entitySubIDs[i - 1] < i_entitySubIDs[i]);
+
+    uint64_t mask = uint64_t(1) << ((ECSIndex)i_entitySubIDs[i] & 0x3F);
+    ECSIndex index = (ECSIndex)i_entitySubIDs[i] >> 6;
+    m_bitData[index] |= mask;
+  }
+
+  // Update the counts once, then get the new indices
+  m_componentCount += i_count;
+  RebuildPrevSum();
+  UpdateVersion();
+  for (ECSIndex i = 0; i < i_count; i++)
+  {
+    o_indices[i] = GetComponentIndex(i_entitySubIDs[i]);
+  }
+}
+
+void ComponentManager::SetBitMask(GroupID i_groupID, const uint64_t* i_mask, std::vector<EntityID>& o_entities, std::vector<ECSIndex>& o_indices)
+{
+  // Set whole bit words at once, recording each new entity
+  o_entities.clear();
+  for (uint32_t i = 0; i < m_bitData.size(); i++)
+  {
+    uint64_t mask = i_mask[i];
+    AT_ASSERT((m_bitData[i] & mask) == 0);
+    m_bitData[i] |= mask;
+
+    ECSIndex count = PopCount64(mask);
+    m_componentCount += count;
+    for (; mask != 0; mask &= mask - 1)
+    {
+      o_entities.push_back(EntityID{ i_groupID, EntitySubID((i << 6) + CountTrailingZeros64(mask)) });
+    }
+  }
+
+  // Update the counts once, then get the new indices
+  RebuildPrevSum();
+  UpdateVersion();
+  o_indices.resize(o_entities.size());
+  for (uint32_t i = 0; i < o_entities.size(); i++)
+  {
+    o_indices[i] = GetComponentIndex(o_entities[i].m_subID);
   }
-  return offset;
 }
 
+void ComponentManager::ClearBits(const EntitySubID* i_entitySubIDs, ECSIndex i_count, ECSIndex* o_indices)
+{
+  AT_ASSERT(m_componentCount >= i_count);
+
+  // Get the existing indices before any bits are cleared
+  for (ECSIndex i = 0; i < i_count; i++)
+  {
+    AT_ASSERT(HasComponent(i_entitySubIDs[i]));
+    AT_ASSERT(i == 0 || i_entitySubIDs[i - 1] < i_entitySubIDs[i]);
+    o_indices[i] = GetComponentIndex(i_entitySubIDs[i]);
+  }
+
+  for (ECSIndex i = 0; i < i_count; i++)
+  {
+    uint64_t mask = uint64_t(1) << ((ECSIndex)i_entitySubIDs[i] & 0x3F);
+    ECSIndex index = (ECSIndex)i_entitySubIDs[i] >> 6;
+    m_bitData[index] &= ~mask;
+  }
+
+  // Update the counts once
+  m_componentCount -= i_count;
+  RebuildPrevSum();
+  UpdateVersion();
+}
+
+uint32_t ComponentManager::FindBitDataIndex(ECSIndex i_componentIndex) const
+{
+  AT_ASSERT(i_componentIndex < m_componentCount);
+
+  // Find the last block that starts at or before the index
+  uint32_t block = uint32_t(std::upper_bound(m_blockSum.begin(), m_blockSum.end(), i_componentIndex) - m_blockSum.begin()) - 1;
+
+  // Find the last bit data item in the block that starts at or before the index
+  uint16_t offset = uint16_t(i_componentIndex - m_blockSum[block]);
+  uint32_t start = block << c_blockShift;
+  uint32_t end = std::min(start + c_blockMask + 1, (uint32_t)m_prevSum.size());
+  return uint32_t(std::upper_bound(m_prevSum.begin() + start, m_prevSum.begin() + end, offset) - m_prevSum.begin()) - 1;
+}
+
+void ComponentManager::AddBitData()
+{
+  // Start a new block if the new bit data item is the first in the block
+  uint32_t index = (uint32_t)m_bitData.size();
+  if ((index & c_blockMask) == 0)
+  {
+    m_blockSum.push_back(m_componentCount);
+    m_summary.push_back(0);
+  }
+
+  m_prevSum.push_back(uint16_t(m_componentCount - m_blockSum.back()));
+  m_bitData.push_back(0);
+}
+
+void ComponentManager::ResizeBitData(uint32_t i_count)
+{
+  ReserveBitData(i_count);
+  while (m_bitData.size() < i_count)
+  {
+    AddBitData();
+  }
+}
+
+void ComponentManager::ReserveBitData(uint32_t i_count)
+{
+  m_bitData.reserve(i_count);
+  m_prevSum.reserve(i_count);
+  m_blockSum.reserve((i_count + c_blockMask) >> c_blockShift);
+  m_summary.reserve((i_count + c_blockMask) >> c_blockShift);
+}
+
+void ComponentManager::UpdatePrevSum(uint32_t i_index, int16_t i_delta)
+{
+  // Update the remaining items in the block
+  uint32_t blockIndex = uint32_t(i_index) >> c_blockShift;
+  uint32_t blockEnd = std::min((blockIndex + 1) << c_blockShift, (uint32_t)m_prevSum.size());
+  for (uint32_t i = uint32_t(i_index) + 1; i < blockEnd; i++)
+  {
+    m_prevSum[i] += i_delta;
+  }
+
+  // Update all following blocks
+  for (uint32_t i = blockIndex + 1; i < m_blockSum.size(); i++)
+  {
+    m_blockSum[i] += i_delta;
+  }
+}
+
+void ComponentManager::RebuildPrevSum()
+{
+  // Rebuild the prefix sums and the summary bitmap in one pass
+  ECSIndex sum = 0;
+  for (uint32_t i = 0; i < m_bitData.size(); i++)
+  {
+    if ((i & c_blockMask) == 0)
+    {
+      m_blockSum[i >> c_blockShift] = sum;
+      m_summary[i >> c_blockShift] = 0;
+    }
+    m_prevSum[i] = uint16_t(sum - m_blockSum[i >> c_blockShift]);
+    if (m_bitData[i] != 0)
+    {
+      m_summary[i >> c_blockShift] |= uint64_t(1) << (i & c_blockMask);
+      sum += PopCount64(m_bitData[i]);
+    }
+  }
+  AT_ASSERT(sum == m_componentCount);
+}
+
+bool ComponentManager::ClearAllBits(GroupID i_groupID, std::vector<EntityID>& o_entities, std::vector<ECSIndex>& o_indices)
+{
+  o_entities.clear();
+  o_indices.clear();
+  if (m_componentCount == 0)
+  {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < m_bitData.size(); i++)
+  {
+    for (uint64_t bits = m_bitData[i]; bits != 0; bits &= bits - 1)
+    {
+      o_entities.push_back(EntityID{ i_groupID, (EntitySubID)((i << 6) + CountTrailingZeros64(bits)) });
+      o_indices.push_back((ECSIndex)o_indices.size());
+    }
+    m_bitData[i] = 0;
+  }
+  m_componentCount = 0;
+  RebuildPrevSum();
+  UpdateVersion();
+  return true;
+}
+
+void ComponentManager::ClearBitData()
+{
+  AT_ASSERT(m_componentCount == 0);
+  m_bitData.clear();
+  m_prevSum.clear();
+  m_blockSum.clear();
+  m_summary.clear();
+}
@@ -1,11 +1,35 @@
 #pragma once
 #include "Common.h"
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <type_traits>
 
-enum class GroupID : uint16_t {};  //!< Supports 65k groups
-enum class EntitySubID : uint16_t {};  //!< Supports 65k entities per group
+/// \brief The compile time configuration of the width of all ids, counts and component indices
+template<typename T>
+struct ECSConfig
+{
+  typedef T Index;                               //!< The type of ids, counts and component indices
+  static const T c_maxIndex = T(~T(0));          //!< The maximum index value (reserved for invalid ids)
+};
+
+// Define AT_ECS_32BIT_IDS to support more than 65k groups and entities per group, at the cost of doubling the size of ids and indices.
+#if defined(AT_ECS_32BIT_IDS)
+typedef ECSConfig<uint32_t> ECSDefaultConfig;
+#else
+typedef ECSConfig<uint16_t> ECSDefaultConfig;
+#endif
+
+typedef ECSDefaultConfig::Index ECSIndex;                  //!< The type of ids, counts and component indices
+const ECSIndex ECSIndex_Max = ECSDefaultConfig::c_maxIndex; //!< The maximum index value (reserved for invalid ids)
+
+enum class GroupID : ECSIndex {};  //!< Supports 65k groups (4 billion with AT_ECS_32BIT_IDS)
+enum class EntitySubID : ECSIndex {};  //!< Supports 65k entities per group (4 billion with AT_ECS_32BIT_IDS)
 
 /// \brief The unique ID of an entity
 struct EntityID
@@ -13,7 +37,7 @@ struct EntityID
   GroupID m_groupID;   //!< Index of the group
   EntitySubID m_subID; //!< Index of the entity in the group
 };
-static_assert(sizeof(EntityID) == 4, "Unexpected size");
+static_assert(sizeof(EntityID) == 2 * sizeof(ECSIndex), "Unexpected size");
 
 inline bool operator == (EntityID a, EntityID b)
 {
@@ -31,7 +55,7 @@ inline bool operator < (EntityID a, EntityID b)
          ((a.m_groupID == b.m_groupID) && (a.m_subID < b.m_subID));
 }
 
-const EntityID EntityID_None { GroupID(UINT16_MAX),  EntitySubID(UINT16_MAX) };
+const EntityID EntityID_None { GroupID(ECSIndex_Max),  EntitySubID(ECSIndex_Max) };
 
 /// \brief Common base class for all flags/components. A bit array for each entity indicating if the component/flag exists for an entity.
 class ComponentFlags
@@ -43,8 +67,8 @@ public:
   /// \return Returns true if this component/flag is on the entity
   inline bool HasComponent(EntitySubID i_entitySubID) const
   {
-    uint64_t mask = uint64_t(1) << ((uint16_t)i_entitySubID & 0x3F);
-    uint16_t index = (uint16_t)i_entitySubID >> 6;
+    uint64_t mask = uint64_t(1) << ((ECSIndex)i_entitySubID & 0x3F);
+    ECSIndex index = (ECSIndex)i_entitySubID >> 6;
 
     return (m_bitData[index] & mask) != 0;
   }
@@ -53,14 +77,26 @@ public:
   /// \return The raw bit array is returned
   inline const std::vector<uint64_t>& GetBits() const { return m_bitData; }
 
+  /// \brief Get the structural version of the bit array. A new version is taken from a global counter each time bits are set or cleared,
+  ///        so a version is unique to one state of one manager (0 is an empty manager). Used to detect when cached queries are out of date.
+  /// \return The version is returned
+  inline uint64_t GetVersion() const { return m_version; }
+
 private:
 
   friend class EntityGroup;
   friend class ComponentManager;
+  template<typename... T> friend class StaticEntityGroup;
   template<typename T> friend class Context;
+  template<typename T> friend class CommandBuffer;
 
   std::vector<uint64_t> m_bitData; //!< The array of bit data
+  uint64_t m_version = 0;          //!< The structural version of the bit data
+
+  static std::atomic<uint64_t> s_versionCounter; //!< The last version given to any manager
 
+  /// \brief Take a new structural version after the bit data has changed
+  inline void UpdateVersion() { m_version = s_versionCounter.fetch_add(1, std::memory_order_relaxed) + 1; }
 };
 
 /// \brief Base class of component managers
@@ -73,42 +109,135 @@ public:
   /// \brief Get the component index for the passed entity id
   /// \param i_entity The sub entity ID to get the component index for
   /// \return The component index is returned
-  inline uint16_t GetComponentIndex(EntitySubID i_entitySubID)
+  inline ECSIndex GetComponentIndex(EntitySubID i_entitySubID)
   {
-    uint64_t mask = uint64_t(1) << ((uint16_t)i_entitySubID & 0x3F);
-    uint16_t index = (uint16_t)i_entitySubID >> 6;
+    uint64_t mask = uint64_t(1) << ((ECSIndex)i_entitySubID & 0x3F);
+    ECSIndex index = (ECSIndex)i_entitySubID >> 6;
 
-    return m_prevSum[index] + PopCount64(GetBits()[index] & (mask - 1));
+    return GetPrevSum(index) + PopCount64(GetBits()[index] & (mask - 1));
   }
 
   /// \brief Get the number of components stored in the manager
   /// \return The component count is returned
-  inline uint16_t GetComponentCount() const { return m_componentCount; }
+  inline ECSIndex GetComponentCount() const { return m_componentCount; }
+
+  /// \brief If the manager stores its data in an order other than entity order (eg. ComponentSparseSetManager). 
+  ///        Unordered managers hide GetDataIndex() to map an entity to its data.
+  static const bool c_unordered = false;
+
+  /// \brief Get the index of the data of the entity that component accessors use.
+  ///        This is the component index unless the manager is unordered.
+  /// \param i_entitySubID The sub entity ID to get the data index for
+  /// \return The data index is returned
+  inline ECSIndex GetDataIndex(EntitySubID i_entitySubID) { return GetComponentIndex(i_entitySubID); }
+
+  /// \brief Get the count of all bits set before the passed bit data item.
+  /// \param i_index The index of the bit data item
+  /// \return The previous sum is returned
+  inline ECSIndex GetPrevSum(uint32_t i_index) const
+  {
+    return m_blockSum[i_index >> c_blockShift] + m_prevSum[i_index];
+  }
 
-  /// \brief Get access to the internal array containing the previous counts of bits per bit data item.
-  /// \return The previous sum array is returned
-  inline const std::vector<uint16_t>& GetPrevSum() const { return m_prevSum; }
+  /// \brief Get the summary bitmap, with one bit set for each non-zero bit data item (one summary item per 64 bit data items)
+  /// \return The summary bits are returned
+  inline const std::vector<uint64_t>& GetSummaryBits() const { return m_summary; }
+
+  /// \brief Find the next bit data item that has any bits set, using the summary bitmap to skip empty regions.
+  /// \param i_start The bit data item index to start searching from (inclusive)
+  /// \return The index of the next non-zero bit data item is returned, or the bit data size if there are none
+  inline uint32_t FindNextBits(uint32_t i_start) const
+  {
+    uint32_t block = i_start >> c_blockShift;
+    if (block >= m_summary.size())
+    {
+      return (uint32_t)m_bitData.size();
+    }
+
+    uint64_t summary = m_summary[block] & (UINT64_MAX << (i_start & c_blockMask));
+    while (summary == 0)
+    {
+      block++;
+      if (block >= m_summary.size())
+      {
+        return (uint32_t)m_bitData.size();
+      }
+      summary = m_summary[block];
+    }
+    return (block << c_blockShift) + CountTrailingZeros64(summary);
+  }
+
+  /// \brief Find the bit data item that holds the component with the passed index (the inverse of GetComponentIndex)
+  /// \param i_componentIndex The component index (must be less than the component count)
+  /// \return The index of the bit data item is returned
+  uint32_t FindBitDataIndex(ECSIndex i_componentIndex) const;
 
   /// \brief Called when a single component is removed from an entity
   /// \param i_entity The entity having the component removed
   /// \param i_index The manager index of the component being removed
-  virtual void OnComponentRemove(EntityID i_entity, uint16_t i_index) = 0;
+  virtual void OnComponentRemove(EntityID i_entity, ECSIndex i_index) = 0;
+
+  /// \brief Called when multiple components are removed from entities in one batch.
+  ///        Default implementation calls OnComponentRemove for each component - override to remove in a single pass.
+  /// \param i_entities The entities having the component removed
+  /// \param i_indices The manager indices of the components being removed (sorted ascending)
+  /// \param i_count The count of components being removed
+  virtual void OnComponentsRemove(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count)
+  {
+    // Remove in reverse order so the remaining indices stay valid
+    for (ECSIndex i = i_count; i > 0; i--)
+    {
+      OnComponentRemove(i_entities[i - 1], i_indices[i - 1]);
+    }
+  }
 
 private:
   friend class EntityGroup;
+  template<typename... T> friend class StaticEntityGroup;
   template<typename T> friend class DebugAccessLock;
   template<typename T> friend class Context;
-
-  uint16_t m_componentCount = 0;   //!< The count of all components stored
-  std::vector<uint16_t> m_prevSum; //!< The sum of all previous bits in the bit array
-  DebugAccessCheck m_accessCheck;  //!< Debug access checker to help prevent misuse of components
-
-  uint16_t SetBit(EntitySubID i_entitySubID);
-  uint16_t ClearBit(EntitySubID i_entitySubID);
+  template<typename T> friend class CommandBuffer;
+
+  static const uint32_t c_blockShift = 6; //!< The shift to go from a bit data item index to a block index (64 bit data items per block)
+  static const uint32_t c_blockMask = (1 << c_blockShift) - 1; //!< The mask of the bit data item index inside a block
+
+  ECSIndex m_componentCount = 0;    //!< The count of all components stored
+  std::vector<uint16_t> m_prevSum;  //!< The sum of all previous bits in the bit array, relative to the start of the block (at most 4096)
+  std::vector<ECSIndex> m_blockSum; //!< The sum of all bits in the previous blocks of the bit array
+  std::vector<uint64_t> m_summary;  //!< One bit per bit data item, set if the bit data item is not zero
+  DebugAccessCheck m_accessCheck;   //!< Debug access checker to help prevent misuse of components
+
+  ECSIndex SetBit(EntitySubID i_entitySubID);
+  ECSIndex ClearBit(EntitySubID i_entitySubID);
+  void SetBits(const EntitySubID* i_entitySubIDs, ECSIndex i_count, ECSIndex* o_indices);
+  void SetBitMask(GroupID i_groupID, const uint64_t* i_mask, std::vector<EntityID>& o_entities, std::vector<ECSIndex>& o_indices);
+  void ClearBits(const EntitySubID* i_entitySubIDs, ECSIndex i_count, ECSIndex* o_indices);
+  void AddBitData();
+  void ResizeBitData(uint32_t i_count);
+  void ReserveBitData(uint32_t i_count);
+  void UpdatePrevSum(uint32_t i_index, int16_t i_delta);
+  void RebuildPrevSum();
+  bool ClearAllBits(GroupID i_groupID, std::vector<EntityID>& o_entities, std::vector<ECSIndex>& o_indices);
+  void ClearBitData();
+
+  /// \brief Update the summary bit of the passed bit data item after it has been changed
+  inline void UpdateSummary(uint32_t i_index)
+  {
+    uint64_t mask = uint64_t(1) << (i_index & c_blockMask);
+    if (m_bitData[i_index] != 0)
+    {
+      m_summary[i_index >> c_blockShift] |= mask;
+    }
+    else
+    {
+      m_summary[i_index >> c_blockShift] &= ~mask;
+    }
+  }
 };
 
-/// \brief Signature of retrieving a component manager from a group
-template <typename T, typename E> T& GetManager(E& i_group);
+/// \brief Signature of retrieving a component manager from a group. 
+///        Groups derived from EntityGroup specialize this for each manager, groups with a GetManager<T>() member (eg. StaticEntityGroup) use it by default.
+template <typename T, typename E> inline T& GetManager(E& i_group) { return i_group.template GetManager<T>(); }
 
 /// \brief Base class of flag managers
 class FlagManager : public ComponentFlags {};
@@ -164,21 +293,77 @@ class ComponentBase
 {
 public:
 
-  uint16_t m_index = 0; //!< The index into the manager of the component
+  ECSIndex m_index = 0; //!< The index into the manager of the component
   DebugAccessLock<T> m_manager; //!< The manager of the component
 
 };
 
+/// \brief Insert multiple values into an array in a single pass. (used to implement batch component adds)
+/// \param io_array The array to insert into
+/// \param i_indices The indices of the inserted values in the resulting array (sorted ascending)
+/// \param i_count The count of values to insert
+/// \param i_getValue Functor returning the value to insert for each index in i_indices
+template<typename A, typename Alloc, typename F>
+inline void InsertAtIndices(std::vector<A, Alloc>& io_array, const ECSIndex* i_indices, ECSIndex i_count, F i_getValue)
+{
+  uint32_t src = (uint32_t)io_array.size();
+  uint32_t dst = src + i_count;
+  io_array.resize(dst);
+
+  // Work backwards from the end, moving existing values up to make room
+  for (ECSIndex i = i_count; i > 0; i--)
+  {
+    uint32_t insertIndex = i_indices[i - 1];
+    while (dst - 1 > insertIndex)
+    {
+      io_array[--dst] = std::move(io_array[--src]);
+    }
+    io_array[--dst] = i_getValue(i - 1);
+  }
+}
+
+/// \brief Erase multiple values from an array in a single pass. (used to implement batch component removes)
+/// \param io_array The array to erase from
+/// \param i_indices The indices of the values to erase (sorted ascending)
+/// \param i_count The count of values to erase
+template<typename A, typename Alloc>
+inline void EraseAtIndices(std::vector<A, Alloc>& io_array, const ECSIndex* i_indices, ECSIndex i_count)
+{
+  if (i_count == 0)
+  {
+    return;
+  }
+
+  uint32_t dst = i_indices[0];
+  uint32_t src = dst;
+  for (ECSIndex i = 0; i < i_count; i++)
+  {
+    // Skip the erased value and move down all values up to the next erased value
+    src++;
+    uint32_t end = (i + 1 < i_count) ? i_indices[i + 1] : (uint32_t)io_array.size();
+    for (; src < end; src++)
+    {
+      io_array[dst++] = std::move(io_array[src]);
+    }
+  }
+  io_array.resize(dst);
+}
+
 /// \brief Template implementation of a ComponentManager to aid implementing components of simple types.
 ///        eg. struct A { /*Data members */ };
 ///            class AManager : ComponentTypeManager<A> {};
-template<typename T>
+///        An allocator can optionally be passed to allocate the data with. (eg. ArenaAllocator in ECSArena.h)
+template<typename T, typename A = std::allocator<T>>
 class ComponentTypeManager : public ComponentManager
 {
 public:
 
+  typedef T DataType; //!< The data type passed when adding components (eg. with a CommandBuffer)
+
+  explicit inline ComponentTypeManager(const A& i_allocator = A()) : m_data(i_allocator) {}
+
   /// \brief The component accessor
-  class Component : public ComponentBase<ComponentTypeManager<T>>
+  class Component : public ComponentBase<ComponentTypeManager<T, A>>
   {
   public:
     inline T* operator->() const { return &this->m_manager->m_data[this->m_index]; }
@@ -186,39 +371,60 @@ public:
     inline T& GetData() const { return this->m_manager->m_data[this->m_index]; }
   };
 
-  inline void OnComponentAdd(EntityID i_entity, uint16_t i_index)
+  inline void OnComponentAdd(EntityID i_entity, ECSIndex i_index)
   {
     m_data.insert(m_data.begin() + i_index, T());
   }
 
-  inline void OnComponentAdd(EntityID i_entity, uint16_t i_index, const T& i_addData)
+  inline void OnComponentAdd(EntityID i_entity, ECSIndex i_index, const T& i_addData)
   {
     m_data.insert(m_data.begin() + i_index, i_addData);
   }
 
-  void OnComponentRemove(EntityID i_entity, uint16_t i_index) override
+  inline void OnComponentsAdd(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count)
+  {
+    InsertAtIndices(m_data, i_indices, i_count, [](ECSIndex) { return T(); });
+  }
+
+  inline void OnComponentsAdd(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count, const T* i_addData)
+  {
+    InsertAtIndices(m_data, i_indices, i_count, [i_addData](ECSIndex i) { return i_addData[i]; });
+  }
+
+  void OnComponentRemove(EntityID i_entity, ECSIndex i_index) override
   {
     m_data.erase(m_data.begin() + i_index);
   }
 
-  inline void ReserveComponent(uint16_t i_count)
+  void OnComponentsRemove(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count) override
+  {
+    EraseAtIndices(m_data, i_indices, i_count);
+  }
+
+  inline void ReserveComponent(ECSIndex i_count)
   {
     m_data.reserve(i_count);
   }
 
-  std::vector<T> m_data; //!< The data stored
+  std::vector<T, A> m_data; //!< The data stored
 
 };
 
 /// \brief Template implementation of a ComponentManager to aid implementing components of simple types with entity IDs.
 ///        eg. struct A { /*Data members */ };
 ///            class AManager : ComponentTypeIDManager<A> {};
-template<typename T>
+///        An allocator can optionally be passed to allocate the data with. (eg. ArenaAllocator in ECSArena.h)
+template<typename T, typename A = std::allocator<T>>
 class ComponentTypeIDManager : public ComponentManager
 {
 public:
 
-  class Component : public ComponentBase<ComponentTypeIDManager<T>>
+  typedef T DataType; //!< The data type passed when adding components (eg. with a CommandBuffer)
+  typedef typename std::allocator_traits<A>::template rebind_alloc<EntitySubID> SubIDAllocator;
+
+  explicit inline ComponentTypeIDManager(const A& i_allocator = A()) : m_data(i_allocator), m_subIDs(SubIDAllocator(i_allocator)) {}
+
+  class Component : public ComponentBase<ComponentTypeIDManager<T, A>>
   {
   public:
     inline T* operator->() const { return &this->m_manager->m_data[this->m_index]; }
@@ -227,37 +433,166 @@ public:
     inline EntitySubID& GetSubID() const { return this->m_manager->m_subIDs[this->m_index]; }
   };
 
-  inline void OnComponentAdd(EntityID i_entity, uint16_t i_index)
+  inline void OnComponentAdd(EntityID i_entity, ECSIndex i_index)
   {
     m_data.insert(m_data.begin() + i_index, T());
     m_subIDs.insert(m_subIDs.begin() + i_index, i_entity.m_subID);
   }
 
-  inline void OnComponentAdd(EntityID i_entity, uint16_t i_index, const T& i_addData)
+  inline void OnComponentAdd(EntityID i_entity, ECSIndex i_index, const T& i_addData)
   {
     m_data.insert(m_data.begin() + i_index, i_addData);
     m_subIDs.insert(m_subIDs.begin() + i_index, i_entity.m_subID);
   }
 
-  void OnComponentRemove(EntityID i_entity, uint16_t i_index) override
+  inline void OnComponentsAdd(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count)
+  {
+    InsertAtIndices(m_data, i_indices, i_count, [](ECSIndex) { return T(); });
+    InsertAtIndices(m_subIDs, i_indices, i_count, [i_entities](ECSIndex i) { return i_entities[i].m_subID; });
+  }
+
+  inline void OnComponentsAdd(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count, const T* i_addData)
+  {
+    InsertAtIndices(m_data, i_indices, i_count, [i_addData](ECSIndex i) { return i_addData[i]; });
+    InsertAtIndices(m_subIDs, i_indices, i_count, [i_entities](ECSIndex i) { return i_entities[i].m_subID; });
+  }
+
+  void OnComponentRemove(EntityID i_entity, ECSIndex i_index) override
   {
     m_data.erase(m_data.begin() + i_index);
     m_subIDs.erase(m_subIDs.begin() + i_index);
   }
 
-  inline void ReserveComponent(uint16_t i_count)
+  void OnComponentsRemove(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count) override
+  {
+    EraseAtIndices(m_data, i_indices, i_count);
+    EraseAtIndices(m_subIDs, i_indices, i_count);
+  }
+
+  inline void ReserveComponent(ECSIndex i_count)
   {
     m_data.reserve(i_count);
     m_subIDs.reserve(i_count);
   }
 
-  std::vector<T> m_data;             //!< The data stored
-  std::vector<EntitySubID> m_subIDs; //!< The sub ID of each element stored
+  std::vector<T, A> m_data;                          //!< The data stored
+  std::vector<EntitySubID, SubIDAllocator> m_subIDs; //!< The sub ID of each element stored
 
 };
 
-/// \brief A entity group base class. This is intended to be inherited from and contain ComponentManagers
-class EntityGroup
+/// \brief Template implementation of a ComponentManager that stores data unordered, for components that are frequently added and removed.
+///        Adding appends the data and removing moves the last data into the removed slot, instead of moving all following data.
+///        Component accessors index the data directly - Iter/IterID iterate in storage order, IterEntity looks up the data of each entity.
+///        eg. struct A { /*Data members */ };
+///            class AManager : ComponentSparseSetManager<A> {};
+///        An allocator can optionally be passed to allocate the data with. (eg. ArenaAllocator in ECSArena.h)
+template<typename T, typename A = std::allocator<T>>
+class ComponentSparseSetManager : public ComponentManager
+{
+public:
+
+  typedef T DataType; //!< The data type passed when adding components (eg. with a CommandBuffer)
+  typedef typename std::allocator_traits<A>::template rebind_alloc<EntitySubID> SubIDAllocator;
+  typedef typename std::allocator_traits<A>::template rebind_alloc<ECSIndex> IndexAllocator;
+
+  explicit inline ComponentSparseSetManager(const A& i_allocator = A()) 
+  : m_data(i_allocator), m_subIDs(SubIDAllocator(i_allocator)), m_dataIndices(IndexAllocator(i_allocator)) {}
+
+  class Component : public ComponentBase<ComponentSparseSetManager<T, A>>
+  {
+  public:
+    inline T* operator->() const { return &this->m_manager->m_data[this->m_index]; }
+    inline T& operator* () const { return this->m_manager->m_data[this->m_index]; }
+    inline T& GetData() const { return this->m_manager->m_data[this->m_index]; }
+    inline EntitySubID& GetSubID() const { return this->m_manager->m_subIDs[this->m_index]; }
+  };
+
+  static const bool c_unordered = true; //!< Data is not stored in entity order
+
+  /// \brief Get the index of the data of the entity
+  /// \param i_entitySubID The sub entity ID (must have the component)
+  /// \return The data index is returned
+  inline ECSIndex GetDataIndex(EntitySubID i_entitySubID) const
+  {
+    AT_ASSERT(HasComponent(i_entitySubID));
+    return m_dataIndices[(ECSIndex)i_entitySubID];
+  }
+
+  inline void OnComponentAdd(EntityID i_entity, ECSIndex i_index)
+  {
+    AddData(i_entity.m_subID, T());
+  }
+
+  inline void OnComponentAdd(EntityID i_entity, ECSIndex i_index, const T& i_addData)
+  {
+    AddData(i_entity.m_subID, i_addData);
+  }
+
+  inline void OnComponentsAdd(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count)
+  {
+    for (ECSIndex i = 0; i < i_count; i++)
+    {
+      AddData(i_entities[i].m_subID, T());
+    }
+  }
+
+  inline void OnComponentsAdd(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count, const T* i_addData)
+  {
+    for (ECSIndex i = 0; i < i_count; i++)
+    {
+      AddData(i_entities[i].m_subID, i_addData[i]);
+    }
+  }
+
+  void OnComponentRemove(EntityID i_entity, ECSIndex i_index) override
+  {
+    // Move the last data into the removed slot
+    ECSIndex dataIndex = m_dataIndices[(ECSIndex)i_entity.m_subID];
+    ECSIndex lastIndex = (ECSIndex)(m_data.size() - 1);
+    if (dataIndex != lastIndex)
+    {
+      m_data[dataIndex] = std::move(m_data[lastIndex]);
+      m_subIDs[dataIndex] = m_subIDs[lastIndex];
+      m_dataIndices[(ECSIndex)m_subIDs[dataIndex]] = dataIndex;
+    }
+    m_data.pop_back();
+    m_subIDs.pop_back();
+  }
+
+  void OnComponentsRemove(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count) override
+  {
+    for (ECSIndex i = 0; i < i_count; i++)
+    {
+      OnComponentRemove(i_entities[i], i_indices[i]);
+    }
+  }
+
+  inline void ReserveComponent(ECSIndex i_count)
+  {
+    m_data.reserve(i_count);
+    m_subIDs.reserve(i_count);
+  }
+
+  std::vector<T, A> m_data;                             //!< The data stored (unordered)
+  std::vector<EntitySubID, SubIDAllocator> m_subIDs;    //!< The sub ID of each element stored
+  std::vector<ECSIndex, IndexAllocator> m_dataIndices;  //!< The data index of each entity in the group (only valid for entities with the component)
+
+private:
+
+  inline void AddData(EntitySubID i_entitySubID, const T& i_data)
+  {
+    if ((ECSIndex)i_entitySubID >= m_dataIndices.size())
+    {
+      m_dataIndices.resize(GetBits().size() * 64);
+    }
+    m_dataIndices[(ECSIndex)i_entitySubID] = (ECSIndex)m_data.size();
+    m_data.push_back(i_data);
+    m_subIDs.push_back(i_entitySubID);
+  }
+};
+
+/// \brief The entity id bookkeeping shared by all entity group types
+class EntityGroupBase
 {
 public:
 
@@ -266,17 +601,38 @@ public:
   /// \return Returns true if the id was valid (may have been reset/deleted however)
   inline bool IsValid(EntitySubID i_entitySubID) const
   {
-    return (uint16_t)i_entitySubID < m_entityCount; // Note: Not checking if currently reset/deleted here
+    return (ECSIndex)i_entitySubID < m_entityCount; // Note: Not checking if currently reset/deleted here
   }
 
   /// \brief Get if count of entities created (includes currently deleted/reset entities)
-  ///        Can have (UINT16_MAX - 1) entities in a group
+  ///        Can have (ECSIndex_Max - 1) entities in a group
   /// \return The count is returned
-  inline uint16_t GetEntityCount() const
+  inline ECSIndex GetEntityCount() const
   {
     return m_entityCount;
   }
 
+protected:
+  template<typename T> friend class Context;
+  template<typename T> friend class CommandBuffer;
+
+  ECSIndex m_entityCount = 0;                 //!< The number of entities created (including removed entities)
+
+  std::vector<uint64_t> m_deletedBits;        //!< Bit array of re-usable entity ids that have been deleted
+  ECSIndex m_deletedCount = 0;                //!< The count of bits set in m_deletedBits
+  uint32_t m_deletedSearchStart = 0;          //!< The first bit data item in m_deletedBits that may have a bit set
+
+  EntitySubID PopDeletedEntity();
+  void PushDeletedEntity(EntitySubID i_entitySubID);
+  bool IsDeleted(EntitySubID i_entitySubID) const;
+  void ResetEntities();
+};
+
+/// \brief A entity group base class. This is intended to be inherited from and contain ComponentManagers
+class EntityGroup : public EntityGroupBase
+{
+public:
+
   /// \brief Add a component manager to the group. Must be done before entities are created.
   /// \param i_manager The component manager
   inline void AddManager(ComponentManager* i_manager)
@@ -296,17 +652,254 @@ public:
 private:
   template<typename T> friend class Context;
 
-  uint16_t m_entityCount = 0;                 //!< The number of entities created (including removed entities)
-
   std::vector<ComponentManager*> m_managers;  //!< Registry array of component managers
   std::vector<FlagManager*> m_flagManagers;   //!< Registry array of single flag managers
 
-  std::vector<EntitySubID> m_deletedEntities; //!< Array of re-usable entity ids that have been deleted
-
   EntitySubID AddEntity();
+  void AddEntities(GroupID i_groupID, ECSIndex i_count, EntityID* o_entities);
   void RemoveEntity(GroupID i_groupID, EntitySubID i_entitySubID);
-  void ReserveEntities(uint16_t i_count);
-  bool IsDeleted(EntitySubID i_entitySubID) const;
+  void RemoveEntities(GroupID i_groupID, const EntitySubID* i_entitySubIDs, ECSIndex i_count);
+  void ReserveEntities(ECSIndex i_count);
+  void Reset(GroupID i_groupID);
+};
+
+/// \brief A entity group with the managers defined at compile time. Managers are stored in a tuple, so GetManager<T> 
+///        does not need to be specialized, and adding/removing entities loops the managers without virtual calls.
+///
+///  Example usage:
+///         typedef StaticEntityGroup<PositionManager, VelocityManager, VisibleFlags> MyGroup;
+///         Context<MyGroup> context;
+///
+///  NOTE: Use the group type directly (eg. with a typedef) - classes derived from a StaticEntityGroup need GetManager specializations.
+template<typename... M>
+class StaticEntityGroup : public EntityGroupBase
+{
+public:
+
+  /// \brief Get the manager of the passed type
+  /// \return The manager is returned
+  template<typename T>
+  inline T& GetManager() { return std::get<T>(m_managers); }
+
+  /// \brief Get the manager of the passed type
+  /// \return The manager is returned
+  template<typename T>
+  inline const T& GetManager() const { return std::get<T>(m_managers); }
+
+private:
+  template<typename T> friend class Context;
+
+  std::tuple<M...> m_managers; //!< The managers of the group
+
+  template<typename T>
+  using IsComponentManager = typename std::is_base_of<ComponentManager, T>::type;
+
+  /// \brief Call the passed function on each manager, in declaration order
+  template<typename F>
+  inline void ForEachManager(F&& i_func) { ForEachManager(i_func, std::index_sequence_for<M...>()); }
+
+  template<typename F, size_t... I>
+  inline void ForEachManager(F& i_func, std::index_sequence<I...>)
+  {
+    int unused[] = { 0, (i_func(std::get<I>(m_managers)), 0)... };
+    (void)unused;
+  }
+
+  inline EntitySubID AddEntity()
+  {
+    // First check if there is a entity id that can be re-used
+    if (m_deletedCount > 0)
+    {
+      return PopDeletedEntity();
+    }
+
+    // Check if the array sizes need to grow
+    AT_ASSERT(m_entityCount < ECSIndex_Max);
+    if ((m_entityCount & 0x3F) == 0)
+    {
+      ForEachManager([](auto& i_manager) { ResizeBits(i_manager, (uint32_t)i_manager.m_bitData.size() + 1, IsComponentManager<std::decay_t<decltype(i_manager)>>()); });
+      m_deletedBits.push_back(0);
+    }
+
+    EntitySubID retID = (EntitySubID)m_entityCount;
+    m_entityCount++;
+    return retID;
+  }
+
+  inline void AddEntities(GroupID i_groupID, ECSIndex i_count, EntityID* o_entities)
+  {
+    // Re-use deleted entity ids first (pulled out in ascending order)
+    ECSIndex count = 0;
+    while (count < i_count && m_deletedCount > 0)
+    {
+      o_entities[count++] = EntityID{ i_groupID, PopDeletedEntity() };
+    }
+
+    ECSIndex newCount = i_count - count;
+    if (newCount == 0)
+    {
+      return;
+    }
+
+    // Grow all the arrays once
+    AT_ASSERT(uint64_t(m_entityCount) + newCount <= ECSIndex_Max);
+    uint32_t bitDataCount = (uint32_t(m_entityCount) + newCount + 63) >> 6;
+    ForEachManager([bitDataCount](auto& i_manager) { ResizeBits(i_manager, bitDataCount, IsComponentManager<std::decay_t<decltype(i_manager)>>()); });
+    m_deletedBits.resize(bitDataCount, 0);
+
+    for (; count < i_count; count++)
+    {
+      o_entities[count] = EntityID{ i_groupID, (EntitySubID)m_entityCount };
+      m_entityCount++;
+    }
+  }
+
+  inline void RemoveEntity(GroupID i_groupID, EntitySubID i_entitySubID)
+  {
+    AT_ASSERT(IsValid(i_entitySubID));
+
+    EntityID entityID{ i_groupID, i_entitySubID };
+    ForEachManager([entityID](auto& i_manager) { RemoveBit(i_manager, entityID, IsComponentManager<std::decay_t<decltype(i_manager)>>()); });
+
+    // Add to the deleted entities
+    PushDeletedEntity(i_entitySubID);
+  }
+
+  inline void RemoveEntities(GroupID i_groupID, const EntitySubID* i_entitySubIDs, ECSIndex i_count)
+  {
+    std::vector<EntitySubID> subIDs;
+    std::vector<EntityID> entities;
+    std::vector<ECSIndex> indices;
+
+    // Remove all components of each manager in one batch
+    ForEachManager([&](auto& i_manager) 
+    {
+      for (ECSIndex i = 0; i < i_count; i++)
+      {
+        AT_ASSERT(IsValid(i_entitySubIDs[i]));
+        RemoveBit(i_manager, EntityID{ i_groupID, i_entitySubIDs[i] }, subIDs, entities, IsComponentManager<std::decay_t<decltype(i_manager)>>());
+      }
+      RemoveBits(i_manager, subIDs, entities, indices, IsComponentManager<std::decay_t<decltype(i_manager)>>());
+    });
+
+    // Add to the deleted entities
+    for (ECSIndex i = 0; i < i_count; i++)
+    {
+      PushDeletedEntity(i_entitySubIDs[i]);
+    }
+  }
+
+  inline void ReserveEntities(ECSIndex i_count)
+  {
+    // Get how many entities to reserve (in multiples of 64)
+    uint32_t existingReserve = ((uint32_t)m_entityCount + 63) >> 6;
+    uint32_t reserveCount = ((uint32_t)i_count + 63) >> 6;
+    if (reserveCount <= existingReserve)
+    {
+      return;
+    }
+
+    ForEachManager([reserveCount](auto& i_manager) { ReserveBits(i_manager, reserveCount, IsComponentManager<std::decay_t<decltype(i_manager)>>()); });
+    m_deletedBits.reserve(reserveCount);
+  }
+
+  inline void Reset(GroupID i_groupID)
+  {
+    std::vector<EntityID> entities;
+    std::vector<ECSIndex> indices;
+    ForEachManager([&](auto& i_manager) { ResetBits(i_manager, i_groupID, entities, indices, IsComponentManager<std::decay_t<decltype(i_manager)>>()); });
+    ResetEntities();
+  }
+
+  // Component manager operations - the remove callbacks are called on the manager type directly to avoid virtual dispatch
+
+  template<typename T>
+  static inline void ResizeBits(T& io_manager, uint32_t i_count, std::true_type) { io_manager.ResizeBitData(i_count); }
+  template<typename T>
+  static inline void ResizeBits(T& io_manager, uint32_t i_count, std::false_type) { io_manager.m_bitData.resize(i_count, 0); }
+
+  template<typename T>
+  static inline void ReserveBits(T& io_manager, uint32_t i_count, std::true_type) { io_manager.ReserveBitData(i_count); }
+  template<typename T>
+  static inline void ReserveBits(T& io_manager, uint32_t i_count, std::false_type) { io_manager.m_bitData.reserve(i_count); }
+
+  template<typename T>
+  static inline void RemoveBit(T& io_manager, EntityID i_entity, std::true_type)
+  {
+    if (io_manager.HasComponent(i_entity.m_subID))
+    {
+      // Debug check that there are no active accessors to the data
+      io_manager.m_accessCheck.CheckLock();
+
+      ECSIndex index = io_manager.ClearBit(i_entity.m_subID);
+      io_manager.T::OnComponentRemove(i_entity, index);
+    }
+  }
+
+  template<typename T>
+  static inline void RemoveBit(T& io_manager, EntityID i_entity, std::false_type)
+  {
+    if (io_manager.HasComponent(i_entity.m_subID))
+    {
+      io_manager.m_bitData[(ECSIndex)i_entity.m_subID >> 6] &= ~(uint64_t(1) << ((ECSIndex)i_entity.m_subID & 0x3F));
+      io_manager.UpdateVersion();
+    }
+  }
+
+  template<typename T>
+  static inline void RemoveBit(T& io_manager, EntityID i_entity, std::vector<EntitySubID>& io_subIDs, std::vector<EntityID>& io_entities, std::true_type)
+  {
+    if (io_manager.HasComponent(i_entity.m_subID))
+    {
+      io_subIDs.push_back(i_entity.m_subID);
+      io_entities.push_back(i_entity);
+    }
+  }
+
+  template<typename T>
+  static inline void RemoveBit(T& io_manager, EntityID i_entity, std::vector<EntitySubID>&, std::vector<EntityID>&, std::false_type)
+  {
+    RemoveBit(io_manager, i_entity, std::false_type());
+  }
+
+  template<typename T>
+  static inline void RemoveBits(T& io_manager, std::vector<EntitySubID>& io_subIDs, std::vector<EntityID>& io_entities, std::vector<ECSIndex>& io_indices, std::true_type)
+  {
+    if (io_subIDs.size() > 0)
+    {
+      // Debug check that there are no active accessors to the data
+      io_manager.m_accessCheck.CheckLock();
+
+      io_indices.resize(io_subIDs.size());
+      io_manager.ClearBits(io_subIDs.data(), (ECSIndex)io_subIDs.size(), io_indices.data());
+      io_manager.T::OnComponentsRemove(io_entities.data(), io_indices.data(), (ECSIndex)io_subIDs.size());
+    }
+    io_subIDs.clear();
+    io_entities.clear();
+  }
+
+  template<typename T>
+  static inline void RemoveBits(T&, std::vector<EntitySubID>&, std::vector<EntityID>&, std::vector<ECSIndex>&, std::false_type) {}
+
+  template<typename T>
+  static inline void ResetBits(T& io_manager, GroupID i_groupID, std::vector<EntityID>& io_entities, std::vector<ECSIndex>& io_indices, std::true_type)
+  {
+    // Debug check that there are no active accessors to the data
+    io_manager.m_accessCheck.CheckLock();
+
+    if (io_manager.ClearAllBits(i_groupID, io_entities, io_indices))
+    {
+      io_manager.T::OnComponentsRemove(io_entities.data(), io_indices.data(), (ECSIndex)io_indices.size());
+    }
+    io_manager.ClearBitData();
+  }
+
+  template<typename T>
+  static inline void ResetBits(T& io_manager, GroupID, std::vector<EntityID>&, std::vector<ECSIndex>&, std::false_type)
+  {
+    io_manager.m_bitData.clear();
+    io_manager.UpdateVersion();
+  }
 };
 
 /// \brief The context that holds all groups and controls access to components.
@@ -322,6 +915,12 @@ public:
       delete e;
     }
     m_groups.clear();
+
+    for (E* e : m_groupPool)
+    {
+      delete e;
+    }
+    m_groupPool.clear();
   }
 
   /// \brief Returns if the group is valid
@@ -329,8 +928,8 @@ public:
   /// \return Returns true for a valid group
   inline bool IsValid(GroupID i_group) const
   {
-    return ((uint16_t)i_group < m_groups.size()) &&
-            (m_groups[(uint16_t)i_group] != nullptr);
+    return ((ECSIndex)i_group < m_groups.size()) &&
+            (m_groups[(ECSIndex)i_group] != nullptr);
   }
 
   /// \brief Returns if the entity is valid (NOTE: Deleted/reset entities are still "valid")
@@ -339,7 +938,7 @@ public:
   inline bool IsValid(EntityID i_entity) const
   {
     return IsValid(i_entity.m_groupID) &&
-           m_groups[(uint16_t)i_entity.m_groupID]->IsValid(i_entity.m_subID);
+           m_groups[(ECSIndex)i_entity.m_groupID]->IsValid(i_entity.m_subID);
   }
 
   /// \brief Add a new entity group
@@ -353,48 +952,116 @@ public:
       AT_ASSERT(!IsValid(retGroup));
 
       m_deletedGroups.pop_back();
-      m_groups[(uint16_t)retGroup] = new E();
+      m_groups[(ECSIndex)retGroup] = NewGroup();
       return retGroup;
     }
 
-    AT_ASSERT(m_groups.size() < UINT16_MAX);
+    AT_ASSERT(m_groups.size() < ECSIndex_Max);
 
     // Add a new item 
-    m_groups.push_back(new E());
+    m_groups.push_back(NewGroup());
     return GroupID(m_groups.size() - 1);
   }
 
   /// \brief Remove an entity group. 
+  ///        If the group pool is not full, the group is reset and kept for re-use by AddEntityGroup, otherwise it is deleted.
   ///        NOTE: Ensure the group is not being accessed (ie. iterated upon) when doing this. (will assert in debug)
   /// \param i_group The group ID to remove
   inline virtual void RemoveEntityGroup(GroupID i_group)
   {
     AT_ASSERT(IsValid(i_group));
 
-    delete m_groups[(uint16_t)i_group];
-    m_groups[(uint16_t)i_group] = nullptr;
+    E* group = m_groups[(ECSIndex)i_group];
+    if (m_groupPool.size() < m_groupPoolSize)
+    {
+      group->Reset(i_group);
+      m_groupPool.push_back(group);
+    }
+    else
+    {
+      delete group;
+    }
+    m_groups[(ECSIndex)i_group] = nullptr;
 
     m_deletedGroups.push_back(i_group);
   }
 
+  /// \brief Set the maximum count of removed groups that are kept for re-use (default 0 - groups are deleted on removal).
+  ///        Pooled groups keep their registered managers and the capacity of all manager arrays, so re-adding a group of
+  ///        a similar size does not re-allocate. Only the state of the managers is reset - other members of E are left as is.
+  /// \param i_count The maximum count of pooled groups (extra pooled groups are deleted)
+  inline void SetGroupPoolSize(uint32_t i_count)
+  {
+    m_groupPoolSize = i_count;
+    while (m_groupPool.size() > m_groupPoolSize)
+    {
+      delete m_groupPool.back();
+      m_groupPool.pop_back();
+    }
+  }
+
+  /// \brief Get the count of removed groups currently held for re-use
+  /// \return The pooled group count is returned
+  inline uint32_t GetPooledGroupCount() const { return (uint32_t)m_groupPool.size(); }
+
   /// \brief Add an entity to the indicated group
   /// \param i_group The group to add to
   /// \return The added entity is returned
   inline EntityID AddEntity(GroupID i_group)
   {
     AT_ASSERT(IsValid(i_group));
-    EntityID newEntity{ i_group , m_groups[(uint16_t)i_group]->AddEntity() };
+    EntityID newEntity{ i_group , m_groups[(ECSIndex)i_group]->AddEntity() };
     AT_ASSERT(newEntity != EntityID_None);
     return newEntity;
   }
 
+  /// \brief Add multiple entities to the indicated group. 
+  ///        Re-uses deleted entity IDs first, then grows all manager arrays once for the remaining entities.
+  /// \param i_group The group to add to
+  /// \param i_count The count of entities to add
+  /// \param o_entities The array to write the added entities to (must have room for i_count entities)
+  inline void AddEntities(GroupID i_group, ECSIndex i_count, EntityID* o_entities)
+  {
+    AT_ASSERT(IsValid(i_group));
+    m_groups[(ECSIndex)i_group]->AddEntities(i_group, i_count, o_entities);
+  }
+
   /// \brief Remove the entity from the context
   ///        NOTE: Ensure the entity is not being accessed (ie. iterated upon) when doing this. (will assert in debug)
   /// \param i_entity The entity to remove.
   inline virtual void RemoveEntity(EntityID i_entity)
   {
     AT_ASSERT(IsValid(i_entity.m_groupID));
-    m_groups[(uint16_t)i_entity.m_groupID]->RemoveEntity(i_entity.m_groupID, i_entity.m_subID);
+    m_groups[(ECSIndex)i_entity.m_groupID]->RemoveEntity(i_entity.m_groupID, i_entity.m_subID);
+  }
+
+  /// \brief Remove multiple entities from the context in one batch. 
+  ///        Each manager clears all bits and updates the counts once, then removes all components in a single pass.
+  ///        NOTE: Ensure the entities are not being accessed (ie. iterated upon) when doing this. (will assert in debug)
+  /// \param i_entities The entities to remove (any order, duplicates are ignored)
+  /// \param i_count The count of entities
+  inline virtual void RemoveEntities(const EntityID* i_entities, uint32_t i_count)
+  {
+    // Sort by group so each group is processed once
+    std::vector<EntityID> entities(i_entities, i_entities + i_count);
+    std::sort(entities.begin(), entities.end());
+    entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+
+    std::vector<EntitySubID> subIDs;
+    for (uint32_t start = 0; start < entities.size(); )
+    {
+      GroupID groupID = entities[start].m_groupID;
+      AT_ASSERT(IsValid(groupID));
+
+      subIDs.clear();
+      uint32_t end = start;
+      for (; end < entities.size() && entities[end].m_groupID == groupID; end++)
+      {
+        subIDs.push_back(entities[end].m_subID);
+      }
+      m_groups[(ECSIndex)groupID]->RemoveEntities(groupID, subIDs.data(), (ECSIndex)subIDs.size());
+      start = end;
+    }
   }
 
   /// \brief Returns if the entity has the component
@@ -410,20 +1077,20 @@ public:
   inline bool HasAllComponents(EntityID i_entity) const
   {
     AT_ASSERT(IsValid(i_entity));
-    uint64_t mask = uint64_t(1) << ((uint16_t)i_entity.m_subID & 0x3F);
-    uint16_t index = (uint16_t)i_entity.m_subID >> 6;
+    uint64_t mask = uint64_t(1) << ((ECSIndex)i_entity.m_subID & 0x3F);
+    ECSIndex index = (ECSIndex)i_entity.m_subID >> 6;
   
-    return HasAllComponents<Args...>(*m_groups[(uint16_t)i_entity.m_groupID], mask, index);
+    return HasAllComponents<Args...>(*m_groups[(ECSIndex)i_entity.m_groupID], mask, index);
   }
 
   template<typename T>
-  inline bool HasAllComponents(E& i_group, uint64_t i_mask, uint16_t i_index) const
+  inline bool HasAllComponents(E& i_group, uint64_t i_mask, ECSIndex i_index) const
   {
     return (GetManager<T>(i_group).GetBits()[i_index] & i_mask) != 0;
   }
 
   template<typename T, typename... Args, typename = typename std::enable_if<(sizeof...(Args)) != 0>::type>
-  inline bool HasAllComponents(E& i_group, uint64_t i_mask, uint16_t i_index) const
+  inline bool HasAllComponents(E& i_group, uint64_t i_mask, ECSIndex i_index) const
   {
     return HasAllComponents<T>(i_group, i_mask, i_index) &&
            HasAllComponents<Args...>(i_group, i_mask, i_index);
@@ -448,11 +1115,11 @@ public:
   inline typename T::Component GetComponent(EntityID i_entity) const
   {
     AT_ASSERT(HasComponent<T>(i_entity));
-    E& group = *m_groups[(uint16_t)i_entity.m_groupID];
+    E& group = *m_groups[(ECSIndex)i_entity.m_groupID];
 
     typename T::Component retType;
     retType.m_manager = &GetManager<T>(group);
-    retType.m_index = retType.m_manager->GetComponentIndex(i_entity.m_subID);
+    retType.m_index = retType.m_manager->GetDataIndex(i_entity.m_subID);
     return retType;
   }
   
@@ -465,7 +1132,7 @@ public:
   {
     AT_ASSERT(IsValid(i_entity));
     AT_ASSERT(!HasComponent<T>(i_entity));
-    E& group = *m_groups[(uint16_t)i_entity.m_groupID];
+    E& group = *m_groups[(ECSIndex)i_entity.m_groupID];
     T& manager = GetManager<T>(group);
 
     // Debug check that there are no active accessors to the data and not deleted
@@ -476,9 +1143,84 @@ public:
     retType.m_manager = &manager;
     retType.m_index = manager.SetBit(i_entity.m_subID);
     manager.OnComponentAdd(i_entity, retType.m_index, i_args...);
+    if (T::c_unordered)
+    {
+      retType.m_index = manager.GetDataIndex(i_entity.m_subID);
+    }
     return retType;
   }
 
+  /// \brief Add a component to all entities set in a bit mask (asserts if any already exist).
+  ///        Sets all bits and updates the counts once, then the manager inserts all components in a single pass.
+  ///        NOTE: The manager must implement OnComponentsAdd(const EntityID*, const ECSIndex*, ECSIndex)
+  /// \param i_group The group of the entities
+  /// \param i_mask The bit mask of entities to add the component to (one uint64_t per 64 entities in the group).
+  ///               Must only contain created, non-deleted entities (will assert in debug)
+  template <class T>
+  inline void AddComponents(GroupID i_group, const uint64_t* i_mask)
+  {
+    AT_ASSERT(IsValid(i_group));
+    E& group = *m_groups[(ECSIndex)i_group];
+    T& manager = GetManager<T>(group);
+
+    // Debug check that there are no active accessors to the data
+    manager.m_accessCheck.CheckLock();
+
+#ifndef NDEBUG
+    // Check the mask only contains live entities before any bits are set
+    for (uint32_t i = 0; i < group.m_deletedBits.size(); i++)
+    {
+      uint64_t liveMask = ~group.m_deletedBits[i];
+      ECSIndex firstEntity = (ECSIndex)(i << 6);
+      if (firstEntity >= group.GetEntityCount())
+      {
+        liveMask = 0;
+      }
+      else if (group.GetEntityCount() - firstEntity < 64)
+      {
+        liveMask &= (uint64_t(1) << (group.GetEntityCount() - firstEntity)) - 1;
+      }
+      AT_ASSERT((i_mask[i] & ~liveMask) == 0);
+    }
+#endif
+
+    std::vector<EntityID> entities;
+    std::vector<ECSIndex> indices;
+    manager.SetBitMask(i_group, i_mask, entities, indices);
+    manager.OnComponentsAdd(entities.data(), indices.data(), (ECSIndex)entities.size());
+  }
+
+  /// \brief Add a component to a range of entities (asserts if any already exist).
+  ///        NOTE: The manager must implement OnComponentsAdd(const EntityID*, const ECSIndex*, ECSIndex, [const D*])
+  /// \param i_group The group of the entities
+  /// \param i_start The first entity in the range
+  /// \param i_count The count of entities in the range
+  /// \param i_args [Optional] Array of i_count items used to construct each component
+  template <class T, typename... Args>
+  inline void AddComponents(GroupID i_group, EntitySubID i_start, ECSIndex i_count, const Args*... i_args)
+  {
+    AT_ASSERT(IsValid(i_group));
+    E& group = *m_groups[(ECSIndex)i_group];
+    T& manager = GetManager<T>(group);
+    AT_ASSERT(group.IsValid(i_start) && ((uint64_t)i_start + i_count) <= group.GetEntityCount());
+
+    // Debug check that there are no active accessors to the data
+    manager.m_accessCheck.CheckLock();
+
+    std::vector<EntityID> entities(i_count);
+    std::vector<EntitySubID> subIDs(i_count);
+    std::vector<ECSIndex> indices(i_count);
+    for (ECSIndex i = 0; i < i_count; i++)
+    {
+      subIDs[i] = EntitySubID((ECSIndex)i_start + i);
+      entities[i] = EntityID{ i_group, subIDs[i] };
+      AT_ASSERT(!group.IsDeleted(subIDs[i]));
+    }
+
+    manager.SetBits(subIDs.data(), i_count, indices.data());
+    manager.OnComponentsAdd(entities.data(), indices.data(), i_count, i_args...);
+  }
+
   /// \brief Remove a component from an entity (asserts if it does not exist)
   /// \param i_entity The entity to remove the component from
   template <class T>
@@ -486,13 +1228,13 @@ public:
   {
     AT_ASSERT(IsValid(i_entity));
     AT_ASSERT(HasComponent<T>(i_entity));
-    E& group = *m_groups[(uint16_t)i_entity.m_groupID];
+    E& group = *m_groups[(ECSIndex)i_entity.m_groupID];
     T& manager = GetManager<T>(group);
 
     // Debug check that there are no active accessors to the data
     manager.m_accessCheck.CheckLock();
 
-    uint16_t index = manager.ClearBit(i_entity.m_subID);
+    ECSIndex index = manager.ClearBit(i_entity.m_subID);
     manager.OnComponentRemove(i_entity, index);
   }
 
@@ -511,7 +1253,7 @@ public:
   inline E* GetGroup(GroupID i_group) const
   {
     AT_ASSERT(IsValid(i_group));
-    E* group = m_groups[(uint16_t)i_group];
+    E* group = m_groups[(ECSIndex)i_group];
     return group;
   }
 
@@ -522,26 +1264,25 @@ public:
   inline void SetFlag(EntityID i_entity, bool i_value)
   {
     AT_ASSERT(IsValid(i_entity));
-    E& group = *m_groups[(uint16_t)i_entity.m_groupID];
+    E& group = *m_groups[(ECSIndex)i_entity.m_groupID];
     FlagManager& manager = GetManager<T>(group);
 
     AT_ASSERT(!group.IsDeleted(i_entity.m_subID));
-    uint64_t mask = uint64_t(1) << ((uint16_t)i_entity.m_subID & 0x3F);
-    uint16_t index = (uint16_t)i_entity.m_subID >> 6;
+    uint64_t mask = uint64_t(1) << ((ECSIndex)i_entity.m_subID & 0x3F);
+    ECSIndex index = (ECSIndex)i_entity.m_subID >> 6;
 
-    if (i_value)
-    {
-      manager.m_bitData[index] |= mask;
-    }
-    else
+    uint64_t testBits = manager.m_bitData[index];
+    uint64_t newBits = i_value ? (testBits | mask) : (testBits & ~mask);
+    if (testBits != newBits)
     {
-      manager.m_bitData[index] &= ~mask;
+      manager.m_bitData[index] = newBits;
+      manager.UpdateVersion();
     }
   }
 
   /// \brief Reserve a count of groups
   /// \param i_count The count of how many groups to reserve
-  inline void ReserveGroups(uint16_t i_count)
+  inline void ReserveGroups(ECSIndex i_count)
   {
     m_groups.reserve(i_count);
   }
@@ -549,20 +1290,20 @@ public:
   /// \brief Reserve a count of entities
   /// \param i_group The group to reserve the entities on
   /// \param i_count The count of how many entities to reserve
-  inline void ReserveEntities(GroupID i_group, uint16_t i_count)
+  inline void ReserveEntities(GroupID i_group, ECSIndex i_count)
   {
     AT_ASSERT(IsValid(i_group));
-    m_groups[(uint16_t)i_group]->ReserveEntities(i_count);
+    m_groups[(ECSIndex)i_group]->ReserveEntities(i_count);
   }
 
   /// \brief Reserve a count of components
   /// \param i_group The group to reserve the components on
   /// \param i_count The count of how many components to reserve
   template <class T>
-  inline void ReserveComponent(GroupID i_group, uint16_t i_count)
+  inline void ReserveComponent(GroupID i_group, ECSIndex i_count)
   {
     AT_ASSERT(IsValid(i_group));
-    E& group = *m_groups[(uint16_t)i_group];
+    E& group = *m_groups[(ECSIndex)i_group];
     T& manager = GetManager<T>(group);
 
     // Debug check that there are no active accessors to the data
@@ -582,5 +1323,19 @@ protected:
 
   std::vector<E*> m_groups;             //!< Array of entity groups
   std::vector<GroupID> m_deletedGroups; //!< Array of re-usable group ids that have been deleted
+  std::vector<E*> m_groupPool;          //!< Removed groups that have been reset for re-use
+  uint32_t m_groupPoolSize = 0;         //!< The maximum count of groups held in the pool
+
+  /// \brief Get a group from the pool, or allocate a new one if the pool is empty
+  inline E* NewGroup()
+  {
+    if (m_groupPool.size() > 0)
+    {
+      E* group = m_groupPool.back();
+      m_groupPool.pop_back();
+      return group;
+    }
+    return new E();
+  }
 };
 
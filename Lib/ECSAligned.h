@@ -0,0 +1,55 @@
+#pragma once
+#include "Common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/// \brief Standard library compatible allocator that aligns allocations and pads them to a multiple of the alignment.
+///  As every allocation is rounded up to whole aligned blocks, SIMD loops can read a full vector past the
+///  last element without leaving the allocation. (eg. with Align = 32, 8 float lanes can be processed with no scalar remainder)
+///  NOTE: Values in the padding are not initialized. (SoALaneField keeps its padding zeroed)
+///
+///  Example usage:
+///         class AlignedFloatManager : public ComponentTypeManager<float, AlignedAllocator<float, 32>> {};
+///
+template<typename T, size_t Align = 64>
+class AlignedAllocator
+{
+public:
+
+  static_assert((Align & (Align - 1)) == 0, "Alignment must be a power of 2");
+  static_assert(Align >= alignof(T), "Alignment must be at least the alignment of the type");
+
+  typedef T value_type;
+  static const size_t c_alignment = Align; //!< The alignment and padding size in bytes
+
+  template<typename U>
+  struct rebind { typedef AlignedAllocator<U, Align> other; };
+
+  inline AlignedAllocator() noexcept {}
+
+  template<typename U>
+  inline AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+
+  inline T* allocate(size_t i_count)
+  {
+    // Round up to whole aligned blocks, with room to align the start and store the original pointer before it
+    size_t size = (i_count * sizeof(T) + Align - 1) & ~(Align - 1);
+    char* raw = static_cast<char*>(::operator new(size + Align - 1 + sizeof(void*)));
+    uintptr_t start = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + Align - 1) & ~uintptr_t(Align - 1);
+    reinterpret_cast<void**>(start)[-1] = raw;
+    return reinterpret_cast<T*>(start);
+  }
+
+  inline void deallocate(T* i_data, size_t) noexcept
+  {
+    ::operator delete(reinterpret_cast<void**>(i_data)[-1]);
+  }
+};
+
+template<typename T, typename U, size_t Align>
+inline bool operator == (const AlignedAllocator<T, Align>&, const AlignedAllocator<U, Align>&) { return true; }
+
+template<typename T, typename U, size_t Align>
+inline bool operator != (const AlignedAllocator<T, Align>&, const AlignedAllocator<U, Align>&) { return false; }
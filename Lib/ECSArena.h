@@ -0,0 +1,127 @@
+#pragma once
+#include "Common.h"
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/// \brief A monotonic arena allocator, intended to be owned by an entity group so all component data of the group is freed at once.
+///  Allocations are taken from large chunks, and individual frees do nothing - all memory is released on Reset() or destruction.
+///  Best suited to short lived groups (eg. a level section or effects), as memory of grown/shrunk arrays is not re-used until reset.
+///
+///  Example usage:
+///         class ArenaIntManager : public ComponentTypeManager<int, ArenaAllocator<int>>
+///         {
+///         public:
+///           using ComponentTypeManager::ComponentTypeManager;
+///         };
+///
+///         class LevelGroup : public EntityGroup
+///         {
+///         public:
+///           LevelGroup() { AddManager(&m_ints); }
+///
+///           GroupArena m_arena; // Must be declared before the managers that use it
+///           ArenaIntManager m_ints { ArenaAllocator<int>(m_arena) };
+///         };
+///
+class GroupArena
+{
+public:
+
+  /// \brief Constructor
+  /// \param i_chunkSize The minimum size of each chunk of memory allocated
+  explicit inline GroupArena(size_t i_chunkSize = 64 * 1024) : m_chunkSize(i_chunkSize) {}
+  inline ~GroupArena() { Reset(); }
+
+  GroupArena(const GroupArena&) = delete;
+  GroupArena& operator=(const GroupArena&) = delete;
+
+  /// \brief Allocate memory from the arena
+  /// \param i_size The size in bytes to allocate
+  /// \param i_align The alignment of the allocation (must be a power of 2)
+  /// \return The allocated memory is returned
+  inline void* Allocate(size_t i_size, size_t i_align)
+  {
+    AT_ASSERT((i_align & (i_align - 1)) == 0);
+    size_t start = (m_current + i_align - 1) & ~(i_align - 1);
+    if (start + i_size > m_end)
+    {
+      AddChunk(i_size + i_align);
+      start = (m_current + i_align - 1) & ~(i_align - 1);
+    }
+    m_current = start + i_size;
+    m_allocatedSize += i_size;
+    return reinterpret_cast<void*>(start);
+  }
+
+  /// \brief Free all memory allocated from the arena.
+  ///        NOTE: All containers using the arena must be destroyed before calling this.
+  inline void Reset()
+  {
+    for (char* c : m_chunks)
+    {
+      ::operator delete(c);
+    }
+    m_chunks.clear();
+    m_current = 0;
+    m_end = 0;
+    m_allocatedSize = 0;
+  }
+
+  /// \brief Get the count of chunks of memory allocated by the arena
+  inline size_t GetChunkCount() const { return m_chunks.size(); }
+
+  /// \brief Get the total size of all allocations made since the last reset
+  inline size_t GetAllocatedSize() const { return m_allocatedSize; }
+
+private:
+
+  inline void AddChunk(size_t i_minSize)
+  {
+    size_t size = (i_minSize > m_chunkSize) ? i_minSize : m_chunkSize;
+    char* chunk = static_cast<char*>(::operator new(size));
+    m_chunks.push_back(chunk);
+    m_current = reinterpret_cast<size_t>(chunk);
+    m_end = m_current + size;
+  }
+
+  size_t m_chunkSize = 0;       //!< The minimum size of each chunk
+  size_t m_current = 0;         //!< The address of the next free byte in the current chunk
+  size_t m_end = 0;             //!< The address of the end of the current chunk
+  size_t m_allocatedSize = 0;   //!< The total size of all allocations
+  std::vector<char*> m_chunks;  //!< All the allocated chunks
+};
+
+/// \brief Standard library compatible allocator that allocates from a GroupArena
+template<typename T>
+class ArenaAllocator
+{
+public:
+
+  typedef T value_type;
+
+  inline ArenaAllocator(GroupArena& i_arena) noexcept : m_arena(&i_arena) {}
+
+  template<typename U>
+  inline ArenaAllocator(const ArenaAllocator<U>& i_other) noexcept : m_arena(i_other.GetArena()) {}
+
+  inline T* allocate(size_t i_count)
+  {
+    return static_cast<T*>(m_arena->Allocate(i_count * sizeof(T), alignof(T)));
+  }
+
+  inline void deallocate(T*, size_t) noexcept {} // Memory is freed when the arena is reset
+
+  inline GroupArena* GetArena() const noexcept { return m_arena; }
+
+private:
+
+  GroupArena* m_arena = nullptr; //!< The arena to allocate from
+};
+
+template<typename T, typename U>
+inline bool operator == (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.GetArena() == b.GetArena(); }
+
+template<typename T, typename U>
+inline bool operator != (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.GetArena() != b.GetArena(); }
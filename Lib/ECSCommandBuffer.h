@@ -0,0 +1,424 @@
+#pragma once
+#include "ECS.h"
+
+#include <algorithm>
+#include <memory>
+
+/// \brief Command buffer to defer structural changes (entity create/remove, component add/remove)
+///  A command buffer can be recorded while iterating or holding component accessors, then applied later with Flush().
+///  Commands are grouped by group and manager on flush, so each manager only does a single merge pass
+///  instead of an array insert/erase per component.
+///
+///  Commands are applied in phases (not in recorded order):
+///   1) Entity creation
+///   2) Component removal
+///   3) Component addition
+///   4) Entity removal
+///  Because of this, a buffer must not both add and remove the same component type on the same entity (will assert in debug).
+///
+///  Example usage:
+///         CommandBuffer<MyGroup> commands;
+///         for (auto& i : IterEntity<A>(context))
+///         {
+///           PendingEntityID newEntity = commands.AddEntity(groupID);
+///           commands.AddComponent<A>(newEntity, data);
+///           commands.RemoveEntity(i.GetEntityID());
+///         }
+///         commands.Flush(context);
+///
+
+/// \brief The ID of an entity that will be created when a command buffer is flushed
+struct PendingEntityID
+{
+  uint32_t m_index; //!< Index of the entity in the created entities array returned from Flush()
+};
+
+template<class E>
+class CommandBuffer
+{
+public:
+
+  /// \brief Record the creation of an entity
+  /// \param i_group The group to create the entity in
+  /// \return The pending entity ID is returned. Can be used with other commands in this buffer.
+  inline PendingEntityID AddEntity(GroupID i_group)
+  {
+    m_addEntities.push_back(i_group);
+    return PendingEntityID{ uint32_t(m_addEntities.size() - 1) };
+  }
+
+  /// \brief Record the removal of an entity
+  /// \param i_entity The entity to remove
+  inline void RemoveEntity(EntityID i_entity) { m_removeEntities.push_back(EntityRef{ i_entity, c_notPending }); }
+  inline void RemoveEntity(PendingEntityID i_entity) { m_removeEntities.push_back(EntityRef{ EntityID_None, i_entity.m_index }); }
+
+  /// \brief Record adding a default component to an entity
+  /// \param i_entity The entity to add the component to
+  template <class T>
+  inline void AddComponent(EntityID i_entity) { GetQueue<AddQueue<T, void>>().Add(EntityRef{ i_entity, c_notPending }); }
+  template <class T>
+  inline void AddComponent(PendingEntityID i_entity) { GetQueue<AddQueue<T, void>>().Add(EntityRef{ EntityID_None, i_entity.m_index }); }
+
+  /// \brief Record adding a component with initial data to an entity.
+  ///        The manager must define DataType and support OnComponentsAdd with an array of it.
+  ///        The data is converted to T::DataType when recorded, so all adds with data for a manager share one queue.
+  /// \param i_entity The entity to add the component to
+  /// \param i_data The data to copy into the component
+  template <class T>
+  inline void AddComponent(EntityID i_entity, const typename T::DataType& i_data) { GetQueue<AddQueue<T, typename T::DataType>>().Add(EntityRef{ i_entity, c_notPending }, i_data); }
+  template <class T>
+  inline void AddComponent(PendingEntityID i_entity, const typename T::DataType& i_data) { GetQueue<AddQueue<T, typename T::DataType>>().Add(EntityRef{ EntityID_None, i_entity.m_index }, i_data); }
+
+  /// \brief Record removing a component from an entity
+  /// \param i_entity The entity to remove the component from
+  template <class T>
+  inline void RemoveComponent(EntityID i_entity) { GetQueue<RemoveQueue<T>>().Add(EntityRef{ i_entity, c_notPending }); }
+
+  /// \brief Get if there are no recorded commands
+  /// \return Returns true if there are no commands
+  inline bool IsEmpty() const
+  {
+    if (m_addEntities.size() > 0 ||
+        m_removeEntities.size() > 0)
+    {
+      return false;
+    }
+    for (const QueueEntry& q : m_queues)
+    {
+      if (!q.m_queue->IsEmpty())
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// \brief Clear all recorded commands (keeps allocated memory)
+  inline void Clear()
+  {
+    m_addEntities.clear();
+    m_removeEntities.clear();
+    for (QueueEntry& q : m_queues)
+    {
+      q.m_queue->Clear();
+    }
+  }
+
+  /// \brief Apply all recorded commands to the context and clear the buffer.
+  ///        NOTE: Ensure no component accessors/iterators are held on the modified managers. (will assert in debug)
+  ///        NOTE: Component removes are applied before component adds, so adding and removing the same component
+  ///              type on the same entity in one buffer is not supported. (will assert in debug)
+  /// \param io_context The context to apply the commands to
+  /// \param o_createdEntities [Optional] Returns the created entities, indexed by PendingEntityID::m_index
+  inline void Flush(Context<E>& io_context, std::vector<EntityID>* o_createdEntities = nullptr)
+  {
+    // Create all entities, in bulk for each run of the same group
+    m_createdEntities.resize(m_addEntities.size());
+    for (uint32_t start = 0; start < m_addEntities.size(); )
+    {
+      uint32_t end = start + 1;
+      while (end < m_addEntities.size() &&
+             m_addEntities[end] == m_addEntities[start])
+      {
+        end++;
+      }
+      io_context.AddEntities(m_addEntities[start], (ECSIndex)(end - start), &m_createdEntities[start]);
+      start = end;
+    }
+
+    // Resolve and sort all component commands
+    for (QueueEntry& q : m_queues)
+    {
+      q.m_queue->Sort(*this);
+    }
+#ifndef NDEBUG
+    CheckAddRemoveConflicts();
+#endif
+
+    // Remove components, then add components
+    for (QueueEntry& q : m_queues)
+    {
+      if (q.m_isRemove)
+      {
+        q.m_queue->Apply(io_context);
+      }
+    }
+    for (QueueEntry& q : m_queues)
+    {
+      if (!q.m_isRemove)
+      {
+        q.m_queue->Apply(io_context);
+      }
+    }
+
+    // Remove entities (via the context so any overridden remove behavior is used)
+    if (m_removeEntities.size() > 0)
+    {
+      m_resolvedEntities.clear();
+      for (const EntityRef& ref : m_removeEntities)
+      {
+        m_resolvedEntities.push_back(Resolve(ref));
+      }
+      io_context.RemoveEntities(m_resolvedEntities.data(), (uint32_t)m_resolvedEntities.size());
+    }
+
+    if (o_createdEntities != nullptr)
+    {
+      o_createdEntities->swap(m_createdEntities);
+    }
+    Clear();
+  }
+
+private:
+
+  static const uint32_t c_notPending = UINT32_MAX; //!< Pending index of an entity that already exists
+
+  /// \brief Reference to an existing or pending entity
+  struct EntityRef
+  {
+    EntityID m_entity;       //!< The existing entity ID
+    uint32_t m_pendingIndex; //!< The pending entity index (c_notPending if an existing entity)
+  };
+
+  /// \brief A recorded component command and the index of any data
+  struct Command
+  {
+    EntityID m_entity;    //!< The entity the command applies to
+    uint32_t m_dataIndex; //!< The index of the command data
+  };
+
+  /// \brief Base type of all per-manager command queues
+  class Queue
+  {
+  public:
+    virtual ~Queue() {}
+    inline bool IsEmpty() const { return m_refs.size() == 0; }
+    virtual void Clear() { m_refs.clear(); }
+    virtual void Apply(Context<E>& io_context) = 0;
+
+    /// \brief Resolve all pending entities and sort commands by group and entity (must be called before Apply)
+    inline void Sort(CommandBuffer& i_buffer)
+    {
+      m_commands.clear();
+      m_commands.reserve(m_refs.size());
+      for (uint32_t i = 0; i < m_refs.size(); i++)
+      {
+        m_commands.push_back(Command{ i_buffer.Resolve(m_refs[i]), i });
+      }
+      std::sort(m_commands.begin(), m_commands.end(), [](const Command& a, const Command& b) { return a.m_entity < b.m_entity; });
+    }
+
+    std::vector<EntityRef> m_refs;      //!< The recorded entities
+    std::vector<Command> m_commands;    //!< Scratch array of sorted commands
+  };
+
+  struct QueueEntry
+  {
+    const void* m_typeKey;          //!< Unique key of the queue type
+    const void* m_managerKey;       //!< Unique key of the component manager type the queue modifies
+    bool m_isRemove;                //!< If the queue removes components
+    std::unique_ptr<Queue> m_queue; //!< The queue
+  };
+
+  /// \brief Base queue of component commands for manager type T
+  template<class T>
+  class ComponentQueue : public Queue
+  {
+  public:
+    typedef T ManagerType;
+
+  protected:
+
+    /// \brief Process each run of commands in the same group
+    /// \param i_process Called with (group, manager, start command, command count)
+    template<typename F>
+    inline void ForEachGroup(Context<E>& io_context, F i_process)
+    {
+      const std::vector<Command>& commands = this->m_commands;
+      for (uint32_t start = 0; start < commands.size(); )
+      {
+        GroupID groupID = commands[start].m_entity.m_groupID;
+        uint32_t end = start + 1;
+        while (end < commands.size() &&
+               commands[end].m_entity.m_groupID == groupID)
+        {
+          end++;
+        }
+
+        AT_ASSERT(io_context.IsValid(groupID));
+        auto& group = *io_context.GetGroup(groupID);
+        T& manager = GetManager<T>(group);
+
+        // Debug check that there are no active accessors to the data
+        manager.m_accessCheck.CheckLock();
+
+        m_entities.clear();
+        m_subIDs.clear();
+        for (uint32_t i = start; i < end; i++)
+        {
+          AT_ASSERT(io_context.IsValid(commands[i].m_entity));
+          AT_ASSERT(!group.IsDeleted(commands[i].m_entity.m_subID));
+          m_entities.push_back(commands[i].m_entity);
+          m_subIDs.push_back(commands[i].m_entity.m_subID);
+        }
+        m_indices.resize(end - start);
+
+        i_process(manager, start, (ECSIndex)(end - start));
+        start = end;
+      }
+    }
+
+    std::vector<EntityID> m_entities;   //!< Scratch array of entities in a group
+    std::vector<EntitySubID> m_subIDs;  //!< Scratch array of entity sub IDs in a group
+    std::vector<ECSIndex> m_indices;    //!< Scratch array of manager indices
+  };
+
+  /// \brief Queue of component adds with data of type D
+  template<class T, typename D>
+  class AddQueue : public ComponentQueue<T>
+  {
+  public:
+    inline void Add(const EntityRef& i_ref, const D& i_data)
+    {
+      this->m_refs.push_back(i_ref);
+      m_data.push_back(i_data);
+    }
+
+    inline void Clear() override
+    {
+      Queue::Clear();
+      m_data.clear();
+    }
+
+    void Apply(Context<E>& io_context) override
+    {
+      this->ForEachGroup(io_context, [this](T& i_manager, uint32_t i_start, ECSIndex i_count)
+      {
+        m_sortedData.clear();
+        for (uint32_t i = i_start; i < i_start + i_count; i++)
+        {
+          m_sortedData.push_back(m_data[this->m_commands[i].m_dataIndex]);
+        }
+
+        i_manager.SetBits(this->m_subIDs.data(), i_count, this->m_indices.data());
+        i_manager.OnComponentsAdd(this->m_entities.data(), this->m_indices.data(), i_count, m_sortedData.data());
+      });
+    }
+
+  private:
+    std::vector<D> m_data;       //!< The recorded component data
+    std::vector<D> m_sortedData; //!< Scratch array of component data sorted by entity
+  };
+
+  /// \brief Queue of default component adds
+  template<class T>
+  class AddQueue<T, void> : public ComponentQueue<T>
+  {
+  public:
+    inline void Add(const EntityRef& i_ref) { this->m_refs.push_back(i_ref); }
+
+    void Apply(Context<E>& io_context) override
+    {
+      this->ForEachGroup(io_context, [this](T& i_manager, uint32_t i_start, ECSIndex i_count)
+      {
+        i_manager.SetBits(this->m_subIDs.data(), i_count, this->m_indices.data());
+        i_manager.OnComponentsAdd(this->m_entities.data(), this->m_indices.data(), i_count);
+      });
+    }
+  };
+
+  /// \brief Queue of component removes
+  template<class T>
+  class RemoveQueue : public ComponentQueue<T>
+  {
+  public:
+    inline void Add(const EntityRef& i_ref) { this->m_refs.push_back(i_ref); }
+
+    void Apply(Context<E>& io_context) override
+    {
+      this->ForEachGroup(io_context, [this](T& i_manager, uint32_t i_start, ECSIndex i_count)
+      {
+        i_manager.ClearBits(this->m_subIDs.data(), i_count, this->m_indices.data());
+        i_manager.OnComponentsRemove(this->m_entities.data(), this->m_indices.data(), i_count);
+      });
+    }
+  };
+
+  template<class Q> struct IsRemoveQueue { static const bool value = false; };
+  template<class T> struct IsRemoveQueue<RemoveQueue<T>> { static const bool value = true; };
+
+  /// \brief Get the queue of the passed type, creating it if necessary
+  template<class Q>
+  inline Q& GetQueue()
+  {
+    // Use the address of a static as a unique key per queue type
+    static const char s_typeKey = 0;
+    for (QueueEntry& q : m_queues)
+    {
+      if (q.m_typeKey == &s_typeKey)
+      {
+        return static_cast<Q&>(*q.m_queue);
+      }
+    }
+
+    m_queues.push_back(QueueEntry{ &s_typeKey, GetManagerKey<typename Q::ManagerType>(), IsRemoveQueue<Q>::value, std::unique_ptr<Queue>(new Q()) });
+    return static_cast<Q&>(*m_queues.back().m_queue);
+  }
+
+  /// \brief Get a unique key per component manager type
+  template<class T>
+  static inline const void* GetManagerKey()
+  {
+    static const char s_managerKey = 0;
+    return &s_managerKey;
+  }
+
+#ifndef NDEBUG
+  /// \brief Assert that no entity has both an add and a remove of the same component type (queues must be sorted)
+  inline void CheckAddRemoveConflicts() const
+  {
+    for (const QueueEntry& remove : m_queues)
+    {
+      if (!remove.m_isRemove)
+      {
+        continue;
+      }
+      for (const QueueEntry& add : m_queues)
+      {
+        if (add.m_isRemove ||
+            add.m_managerKey != remove.m_managerKey)
+        {
+          continue;
+        }
+
+        // Both command arrays are sorted by entity, so walk them together
+        const std::vector<Command>& removes = remove.m_queue->m_commands;
+        const std::vector<Command>& adds = add.m_queue->m_commands;
+        for (size_t r = 0, a = 0; r < removes.size() && a < adds.size(); )
+        {
+          AT_ASSERT(removes[r].m_entity != adds[a].m_entity);
+          if (removes[r].m_entity < adds[a].m_entity) { r++; }
+          else { a++; }
+        }
+      }
+    }
+  }
+#endif
+
+  /// \brief Get the entity ID of an entity reference (must be called after pending entities are created)
+  inline EntityID Resolve(const EntityRef& i_ref) const
+  {
+    if (i_ref.m_pendingIndex == c_notPending)
+    {
+      return i_ref.m_entity;
+    }
+    AT_ASSERT(i_ref.m_pendingIndex < m_createdEntities.size());
+    return m_createdEntities[i_ref.m_pendingIndex];
+  }
+
+  std::vector<GroupID> m_addEntities;      //!< The groups of entities to create
+  std::vector<EntityRef> m_removeEntities; //!< The entities to remove
+  std::vector<QueueEntry> m_queues;        //!< The per-manager component command queues
+  std::vector<EntityID> m_createdEntities; //!< The entities created during flush
+  std::vector<EntityID> m_resolvedEntities; //!< Scratch array of entities to remove
+};
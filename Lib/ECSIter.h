@@ -10,7 +10,13 @@
 ///
 ///  - IterEntity<A> - Iterates each entity in the context, stopping at entities that have the component. 
 ///    Can filter on as many components/flags as necessary. (eg IterEntity<A, B, C, D...> will only stop on entities that have all listed components/flags)
-///    First filter type must be a component and not a flag.
+///    First filter type must be a component and not a flag (use IterFlags<F> to iterate flags).
+///    The bits of all filters are intersected 512 entities at a time into a scratch mask (with AVX2/SSE2 if available, see IntersectBits64).
+///    Without<B> filters only stop at entities that do not have B, Optional<B> filters give access to B when the entity has it (see GetOptional()).
+///    Component filters can be accessed with GetComponent<B>() without looking up the entity (see IterJoin).
+///
+///  - IterFlags<F> - Iterates each entity that has flag F set, taking the same filters as IterEntity (eg IterFlags<F, A, Without<B>>).
+///    Only visits entities with the flag set, so sweeps of sparse flags (eg. dirty flags) do not scan every entity.
 ///   
 ///  Example usage: 
 ///         for (auto& i : Iter<A>(context))
@@ -24,6 +30,21 @@
 ///         { *i = foo;       // Access component A data like a pointer
 ///           i.GetEntityID() // Entity has component A and component/flag B
 ///
+///         for (auto& i : IterEntity<A, B>(context))
+///         { i.GetComponent<B>() // Access component B of the entity
+///
+///         for (auto& i : IterEntity<A, Without<B>, Optional<C>>(context))
+///         { // Entity has component A and not component/flag B
+///           C::Component c;
+///           if (i.GetOptional<C>(c)) { *c = foo; } // Access component C data if the entity has it
+///
+///         for (auto& i : IterFlags<F, A>(context))
+///         { i.GetEntityID()       // Entity has flag F and component A
+///           i.GetComponent<A>()   // Access component A
+///
+///  Unordered managers (eg. ComponentSparseSetManager) are iterated in storage order by Iter<A>/IterID<A>.
+///  IterEntity<A> still visits entities in order, looking up the data of each entity.
+///
 ///  To restrict iteration to an entity group, pass the group ID as a second argument to any of the iterator types.
 ///  Example:
 ///         for (auto& i : IterEntity<A, B>(context, groupID))
@@ -34,10 +55,10 @@ template <class T>
 struct IterProcessValue : public T::Component
 {
 protected:
-  uint16_t m_groupIndex = 0;
+  ECSIndex m_groupIndex = 0;
 
 public:
-  inline EntityID GetGroupID() const { return (GroupID)m_groupIndex; }
+  inline GroupID GetGroupID() const { return (GroupID)m_groupIndex; }
 };
 
 template <class T>
@@ -45,7 +66,7 @@ struct IterProcessValueID : public IterProcessValue<T>
 {
 public:
   // Note: This relies on the component type implementing GetSubID() - use Iter/IterEntities instead on compile failure
-  inline EntityID GetEntityID() const { return EntityID{ (GroupID)m_groupIndex, GetSubID() }; }
+  inline EntityID GetEntityID() const { return EntityID{ (GroupID)this->m_groupIndex, this->GetSubID() }; }
 };
 
 template <class T, class E, typename V>
@@ -56,7 +77,11 @@ public:
 
   struct Iterator : public V
   {
-    uint16_t m_componentCount = 0;
+    using V::m_index;
+    using V::m_manager;
+    using V::m_groupIndex;
+
+    ECSIndex m_componentCount = 0;
     const Context<E>& m_context;
 
     inline Iterator(const Context<E> &i_context)
@@ -96,12 +121,12 @@ public:
       }
     }
 
-    inline bool operator != (uint16_t a_other) const { return this->m_groupIndex != a_other; }
+    inline bool operator != (ECSIndex a_other) const { return this->m_groupIndex != a_other; }
     inline V& operator *() { return *this; }
   };
 
   inline Iterator begin() { return Iterator(m_context); }
-  inline uint16_t end() { return (uint16_t)m_context.GetGroups().size(); }
+  inline ECSIndex end() { return (ECSIndex)m_context.GetGroups().size(); }
 
   const Context<E>& m_context;
 };
@@ -121,14 +146,18 @@ public:
 
   struct Iterator : public V
   {
-    inline Iterator(GroupID i_group, T &i_manager) { m_groupIndex = (uint16_t)i_group; m_manager = &i_manager; }
+    using V::m_index;
+    using V::m_manager;
+    using V::m_groupIndex;
+
+    inline Iterator(GroupID i_group, T &i_manager) { m_groupIndex = (ECSIndex)i_group; m_manager = &i_manager; }
     inline Iterator& operator++() { m_index++; return *this; }
-    inline bool operator != (uint16_t a_other) const { return this->m_index != a_other; }
+    inline bool operator != (ECSIndex a_other) const { return this->m_index != a_other; }
     inline V& operator *() { return *this; }
   };
 
   inline Iterator begin() { return Iterator(m_group, m_manager); }
-  inline uint16_t end() { return m_manager.GetComponentCount(); }
+  inline ECSIndex end() { return m_manager.GetComponentCount(); }
 
   GroupID m_group;
   T& m_manager;
@@ -152,8 +181,8 @@ public:
   {
   protected:
 
-    uint16_t m_groupIndex = 0;
-    uint16_t m_entitySubID = 0;
+    ECSIndex m_groupIndex = 0;
+    ECSIndex m_entitySubID = 0;
 
   public:
 
@@ -165,8 +194,15 @@ public:
 
   struct Iterator : public Value
   {
-    uint16_t m_componentCount = 0;
-    uint64_t m_bits;
+    using Value::m_index;
+    using Value::m_manager;
+    using Value::m_groupIndex;
+    using Value::m_entitySubID;
+
+    ECSIndex m_componentCount = 0;
+    ECSIndex m_visitIndex = 0; //!< The count of entities visited in the current group (the component index if the manager is ordered)
+    uint64_t m_bits = 0; //!< The remaining bits of the current bit data item (current entity is the lowest bit)
+    uint32_t m_denseEnd = 0; //!< One past the last entity of the current bit data item if all its bits are set (else 0)
     const Context<E>& m_context;
 
     inline Iterator(const Context<E> &i_context)
@@ -177,8 +213,14 @@ public:
 
     inline Iterator& operator++()
     {
-      m_index++;
-      if (m_index == m_componentCount)
+      m_visitIndex++;
+      if (m_entitySubID + 1u < m_denseEnd)
+      {
+        // Full bit data item (dense components) - the next entity is the next bit
+        m_entitySubID++;
+        UpdateDataIndex();
+      }
+      else if (m_visitIndex == m_componentCount)
       {
         m_groupIndex++;
         UpdateGroupIndex();
@@ -193,8 +235,7 @@ public:
 
     inline void UpdateGroupIndex()
     {
-      m_entitySubID = 0;
-      m_index = 0;
+      m_visitIndex = 0;
       m_componentCount = 0;
       for (; m_groupIndex < m_context.GetGroups().size(); m_groupIndex++)
       {
@@ -205,22 +246,8 @@ public:
           m_componentCount = m_manager->GetComponentCount();
           if (m_componentCount > 0)
           {
-            // Skip starting zero areas
-            for (uint64_t bits : m_manager->GetBits())
-            {
-              if (bits != 0)
-              {
-                m_bits = bits;
-                break;
-              }
-              m_entitySubID += 64;
-            }
-
-            // If not the first bit, go to the next
-            if ((m_bits & 0x1) == 0)
-            {
-              UpdateEntityID();
-            }
+            FindBits(0);
+            UpdateDataIndex();
             break;
           }
         }
@@ -229,33 +256,39 @@ public:
 
     inline void UpdateEntityID()
     {
-      do
+      // Clear the current bit and jump to the next set bit (a full bit data item is done when its last entity is reached)
+      m_bits &= m_bits - 1;
+      if (m_bits == 0 || m_denseEnd != 0)
       {
-        // Go to next bit
-        m_bits >>= 1;
-        m_entitySubID++;
-        if ((m_entitySubID & 0x3F) == 0)
-        {
-          // Skip long runs of 0 bits
-          for (uint32_t i = (m_entitySubID >> 6); ; i++)
-          {
-            m_bits = m_manager->GetBits()[i];
-            if (m_bits != 0)
-            {
-              break;
-            }
-            m_entitySubID += 64;
-          }
-        }
-      } while ((m_bits & 0x1) == 0);
+        FindBits(uint32_t(m_entitySubID >> 6) + 1);
+      }
+      else
+      {
+        m_entitySubID = (m_entitySubID & ~0x3F) + CountTrailingZeros64(m_bits);
+      }
+      UpdateDataIndex();
+    }
+
+    inline void UpdateDataIndex()
+    {
+      m_index = T::c_unordered ? m_manager->GetDataIndex((EntitySubID)m_entitySubID) : m_visitIndex;
+    }
+
+    inline void FindBits(uint32_t i_start)
+    {
+      // Skip long runs of 0 bits using the summary bitmap (component count ensures there is a set bit)
+      uint32_t i = m_manager->FindNextBits(i_start);
+      m_bits = m_manager->GetBits()[i];
+      m_entitySubID = ECSIndex((i << 6) + CountTrailingZeros64(m_bits));
+      m_denseEnd = (m_bits == ~uint64_t(0)) ? (i << 6) + 64 : 0;
     }
 
-    inline bool operator != (uint16_t a_other) const { return this->m_groupIndex != a_other; }
+    inline bool operator != (ECSIndex a_other) const { return this->m_groupIndex != a_other; }
     inline Value& operator *() { return *this; }
   };
 
   inline Iterator begin() { return Iterator(m_context); }
-  inline uint16_t end() { return (uint16_t)m_context.GetGroups().size(); }
+  inline ECSIndex end() { return (ECSIndex)m_context.GetGroups().size(); }
 
   const Context<E>& m_context;
 };
@@ -275,8 +308,8 @@ public:
   {
   protected:
 
-    uint16_t m_groupIndex = 0;
-    uint16_t m_entitySubID = 0;
+    ECSIndex m_groupIndex = 0;
+    ECSIndex m_entitySubID = 0;
 
   public:
 
@@ -288,38 +321,37 @@ public:
 
   struct Iterator : public Value
   {
-    uint64_t m_bits = 0;
+    using Value::m_index;
+    using Value::m_manager;
+    using Value::m_groupIndex;
+    using Value::m_entitySubID;
+
+    ECSIndex m_visitIndex = 0; //!< The count of entities visited (the component index if the manager is ordered)
+    uint64_t m_bits = 0; //!< The remaining bits of the current bit data item (current entity is the lowest bit)
+    uint32_t m_denseEnd = 0; //!< One past the last entity of the current bit data item if all its bits are set (else 0)
 
     inline Iterator(GroupID i_group, T &i_manager) 
     {
-      m_groupIndex = (uint16_t)i_group;
+      m_groupIndex = (ECSIndex)i_group;
       m_manager = &i_manager;
 
       if (m_manager->GetComponentCount() > 0)
       {
-        // Skip starting zero areas
-        for (uint64_t bits : m_manager->GetBits())
-        {
-          if (bits != 0)
-          {
-            m_bits = bits;
-            break;
-          }
-          m_entitySubID += 64;
-        }
-
-        // If not the first bit, go to the next
-        if ((m_bits & 0x1) == 0)
-        {
-          UpdateEntityID();
-        }
+        FindBits(0);
+        UpdateDataIndex();
       }
     }
 
     inline Iterator& operator++()
     {
-      m_index++;
-      if (m_index < m_manager->GetComponentCount())
+      m_visitIndex++;
+      if (m_entitySubID + 1u < m_denseEnd)
+      {
+        // Full bit data item (dense components) - the next entity is the next bit
+        m_entitySubID++;
+        UpdateDataIndex();
+      }
+      else if (m_visitIndex < m_manager->GetComponentCount())
       {
         UpdateEntityID();
       }
@@ -328,33 +360,39 @@ public:
 
     inline void UpdateEntityID()
     {
-      do
+      // Clear the current bit and jump to the next set bit (a full bit data item is done when its last entity is reached)
+      m_bits &= m_bits - 1;
+      if (m_bits == 0 || m_denseEnd != 0)
       {
-        // Go to next bit
-        m_bits >>= 1;
-        m_entitySubID++;
-        if ((m_entitySubID & 0x3F) == 0)
-        {
-          // Skip long runs of 0 bits
-          for (uint32_t i = (m_entitySubID >> 6); ; i++)
-          {
-            m_bits = m_manager->GetBits()[i];
-            if (m_bits != 0)
-            {
-              break;
-            }
-            m_entitySubID += 64;
-          }
-        }
-      } while ((m_bits & 0x1) == 0);
+        FindBits(uint32_t(m_entitySubID >> 6) + 1);
+      }
+      else
+      {
+        m_entitySubID = (m_entitySubID & ~0x3F) + CountTrailingZeros64(m_bits);
+      }
+      UpdateDataIndex();
+    }
+
+    inline void UpdateDataIndex()
+    {
+      m_index = T::c_unordered ? m_manager->GetDataIndex((EntitySubID)m_entitySubID) : m_visitIndex;
     }
 
-    inline bool operator != (uint16_t a_other) const { return this->m_index != a_other; }
+    inline void FindBits(uint32_t i_start)
+    {
+      // Skip long runs of 0 bits using the summary bitmap (component count ensures there is a set bit)
+      uint32_t i = m_manager->FindNextBits(i_start);
+      m_bits = m_manager->GetBits()[i];
+      m_entitySubID = ECSIndex((i << 6) + CountTrailingZeros64(m_bits));
+      m_denseEnd = (m_bits == ~uint64_t(0)) ? (i << 6) + 64 : 0;
+    }
+
+    inline bool operator != (ECSIndex a_other) const { return this->m_visitIndex != a_other; }
     inline Value& operator *() { return *this; }
   };
 
   inline Iterator begin() { return Iterator(m_group, m_manager); }
-  inline uint16_t end() { return m_manager.GetComponentCount(); }
+  inline ECSIndex end() { return m_manager.GetComponentCount(); }
 
   GroupID m_group;
   T& m_manager;
@@ -365,6 +403,232 @@ auto IterEntity(const C<E> &i_context, GroupID i_groupID) { return IterEntityPro
 
 
 
+static const uint32_t c_filterBlockWords = 8; //!< The count of bit data items (512 entities) intersected at once by filtered iteration
+
+/// \brief IterEntity filter - only stop at entities that do NOT have component/flag T
+template <class T>
+struct Without {};
+
+/// \brief IterEntity filter - does not restrict iteration, but allows access to component T of entities that have it (see GetOptional())
+template <class T>
+struct Optional {};
+
+/// \brief How a filter type of IterEntity contributes to the intersected bits (components/flags must be set)
+template <class A>
+struct IterFilter
+{
+  static const uint32_t c_includeCount = 1;
+  static const uint32_t c_excludeCount = 0;
+  static const uint32_t c_joinCount = std::is_base_of<ComponentManager, A>::value ? 1 : 0; //!< Components (not flags) are joined, see IterJoin
+
+  template <class E>
+  static inline void AddBits(E& i_group, uint32_t i_start, const uint64_t**& io_include, const uint64_t**&) { *io_include++ = GetManager<A>(i_group).GetBits().data() + i_start; }
+
+  template <class E>
+  static inline void AddJoin(E& i_group, ComponentManager**& io_join) { AddJoin(i_group, io_join, std::integral_constant<bool, c_joinCount != 0>()); }
+
+private:
+  template <class E>
+  static inline void AddJoin(E& i_group, ComponentManager**& io_join, std::true_type) { *io_join++ = &GetManager<A>(i_group); }
+  template <class E>
+  static inline void AddJoin(E&, ComponentManager**&, std::false_type) {}
+};
+
+/// \brief Without<A> bits are removed from the intersected bits
+template <class A>
+struct IterFilter<Without<A>>
+{
+  static const uint32_t c_includeCount = 0;
+  static const uint32_t c_excludeCount = 1;
+  static const uint32_t c_joinCount = 0;
+
+  template <class E>
+  static inline void AddBits(E& i_group, uint32_t i_start, const uint64_t**&, const uint64_t**& io_exclude) { *io_exclude++ = GetManager<A>(i_group).GetBits().data() + i_start; }
+  template <class E>
+  static inline void AddJoin(E&, ComponentManager**&) {}
+};
+
+/// \brief Optional<A> does not change the intersected bits
+template <class A>
+struct IterFilter<Optional<A>>
+{
+  static const uint32_t c_includeCount = 0;
+  static const uint32_t c_excludeCount = 0;
+  static const uint32_t c_joinCount = 0;
+
+  template <class E>
+  static inline void AddBits(E&, uint32_t, const uint64_t**&, const uint64_t**&) {}
+  template <class E>
+  static inline void AddJoin(E&, ComponentManager**&) {}
+};
+
+template <typename... Args>
+struct IterFilterCounts
+{
+  static const uint32_t c_includeCount = 0;
+  static const uint32_t c_excludeCount = 0;
+  static const uint32_t c_joinCount = 0;
+};
+
+template <typename H, typename... Tail>
+struct IterFilterCounts<H, Tail...>
+{
+  static const uint32_t c_includeCount = IterFilter<H>::c_includeCount + IterFilterCounts<Tail...>::c_includeCount;
+  static const uint32_t c_excludeCount = IterFilter<H>::c_excludeCount + IterFilterCounts<Tail...>::c_excludeCount;
+  static const uint32_t c_joinCount = IterFilter<H>::c_joinCount + IterFilterCounts<Tail...>::c_joinCount;
+};
+
+template <class O, typename... Args>
+struct IsOptionalFilter { static const bool value = false; };
+
+template <class O, typename H, typename... Tail>
+struct IsOptionalFilter<O, H, Tail...> { static const bool value = std::is_same<H, Optional<O>>::value || IsOptionalFilter<O, Tail...>::value; };
+
+/// \brief Get the accessor of component O of an entity, if the entity has it (used by GetOptional() of filtered iteration)
+/// \param i_group The group of the entity
+/// \param i_entitySubID The entity
+/// \param o_component Returns the component accessor if the entity has the component
+/// \return Returns true if the entity has the component
+template <class O, class E>
+inline bool GetIterOptional(E& i_group, EntitySubID i_entitySubID, typename O::Component& o_component)
+{
+  O& manager = GetManager<O>(i_group);
+  uint32_t index = uint32_t((ECSIndex)i_entitySubID >> 6);
+  uint64_t bit = uint64_t(1) << ((ECSIndex)i_entitySubID & 0x3F);
+  uint64_t bits = manager.GetBits()[index];
+  if ((bits & bit) == 0)
+  {
+    return false;
+  }
+
+  // The prefix sum gives the component index of the first component of the bit data item
+  o_component.m_manager = &manager;
+  o_component.m_index = O::c_unordered ? manager.GetDataIndex(i_entitySubID) :
+                                         ECSIndex(manager.GetPrevSum(index) + PopCount64(bits & (bit - 1)));
+  return true;
+}
+
+/// \brief The index of component O in the joined components of an iterator (see IterJoin)
+template <class O, typename... Args>
+struct IterJoinSlot
+{
+  static const bool c_found = false;
+  static const uint32_t value = 0;
+};
+
+template <class O, typename H, typename... Tail>
+struct IterJoinSlot<O, H, Tail...>
+{
+  static const bool c_found = std::is_same<H, O>::value || IterJoinSlot<O, Tail...>::c_found;
+  static const uint32_t value = std::is_same<H, O>::value ? 0 : IterFilter<H>::c_joinCount + IterJoinSlot<O, Tail...>::value;
+};
+
+/// \brief The component indices of the current entity of filtered iteration, for each component (not flag) of the iterated types J
+///        (the iterated component/flag, then the filters).
+///        The prefix sum and bits of a joined component are only read when its index is needed, and are cached per bit data item,
+///        so iterators that never access a joined component pay nothing, and the index of an entity is usually one popcount
+///        of the bits before it (no group or entity lookup).
+template <typename... J>
+struct IterJoin
+{
+  static const uint32_t c_joinCount = IterFilterCounts<J...>::c_joinCount;
+  static const uint32_t c_arraySize = (c_joinCount > 0) ? c_joinCount : 1; //!< (Avoids zero sized arrays when only flags are iterated)
+
+  ComponentManager* m_managers[c_arraySize]; //!< The manager of each joined component, in order
+  mutable ECSIndex m_prevSums[c_arraySize];  //!< The component index of the first component of the current bit data item
+  mutable uint64_t m_bits[c_arraySize];      //!< The bits of each joined component in the current bit data item
+  mutable uint32_t m_read = 0;               //!< One bit per joined component with the prefix sum and bits of the current bit data item read
+  uint32_t m_item = 0;                       //!< The current bit data item
+  uint64_t m_below = 0;                      //!< The mask of the bits before the current entity
+  uint32_t m_bitIndex = 0;                   //!< The bit of the current entity in the current bit data item
+
+  static_assert(c_joinCount <= 32, "Too many joined components");
+
+  /// \brief Set the managers of a group
+  template <class E>
+  inline void SetGroup(E& i_group)
+  {
+    ComponentManager** join = m_managers;
+    int unused[] = { 0, (IterFilter<J>::AddJoin(i_group, join), 0)... };
+    (void)unused;
+  }
+
+  /// \brief Move to a new bit data item (nothing is read until the index of a joined component is needed)
+  inline void SetBitData(uint32_t i_index)
+  {
+    m_item = i_index;
+    m_read = 0;
+  }
+
+  /// \brief Move to an entity of the current bit data item
+  inline void SetBit(uint32_t i_bitIndex)
+  {
+    m_below = (uint64_t(1) << i_bitIndex) - 1;
+    m_bitIndex = i_bitIndex;
+  }
+
+  /// \brief Get the component index of the current entity of a joined component
+  ///        (the prefix sum and bits are read on the first call for the component in each bit data item)
+  inline ECSIndex GetIndex(uint32_t i_slot) const
+  {
+    if ((m_read & (1u << i_slot)) == 0)
+    {
+      m_read |= 1u << i_slot;
+      m_prevSums[i_slot] = m_managers[i_slot]->GetPrevSum(m_item);
+      m_bits[i_slot] = m_managers[i_slot]->GetBits()[m_item];
+    }
+#if defined(AT_NATIVE_POPCOUNT)
+    return ECSIndex(m_prevSums[i_slot] + PopCount64(m_bits[i_slot] & m_below));
+#else
+    // (skip the software popcount when every entity of the bit data item has the component)
+    uint64_t bits = m_bits[i_slot];
+    return ECSIndex(m_prevSums[i_slot] + ((bits == ~uint64_t(0)) ? m_bitIndex : PopCount64(bits & m_below)));
+#endif
+  }
+
+  /// \brief Get the accessor of joined component O of the current entity
+  template <class O>
+  inline typename O::Component Get(EntitySubID i_entitySubID) const
+  {
+    typedef IterJoinSlot<O, J...> Slot;
+    static_assert(Slot::c_found, "Component must be the iterated component or a component filter of the iterator");
+    typename O::Component component;
+    component.m_manager = static_cast<O*>(m_managers[Slot::value]);
+    component.m_index = O::c_unordered ? component.m_manager->GetDataIndex(i_entitySubID) : GetIndex(Slot::value);
+    return component;
+  }
+};
+
+/// \brief Intersect the bits of a component with the bits of all filters of a block of bit data items
+///        (the bits of Without<> filters are removed, Optional<> filters are ignored)
+/// \param i_componentBits The component bits of the block
+/// \param i_group The group of the component
+/// \param i_start The first bit data item of the block
+/// \param i_count The count of bit data items of the block (at most c_filterBlockWords)
+/// \param o_mask Returns the intersected bits
+/// \return Returns true if any entity of the block matches
+template <typename... Args, class E>
+inline bool IntersectFilterBits(const uint64_t* i_componentBits, E& i_group, uint32_t i_start, uint32_t i_count, uint64_t* o_mask)
+{
+  typedef IterFilterCounts<Args...> Counts;
+  const uint64_t* includes[1 + Counts::c_includeCount];
+  const uint64_t* excludes[Counts::c_excludeCount + 1] = {}; // (+1 to avoid a zero sized array)
+  includes[0] = i_componentBits;
+
+  const uint64_t** include = includes + 1;
+  const uint64_t** exclude = excludes;
+  int unused[] = { 0, (IterFilter<Args>::AddBits(i_group, i_start, include, exclude), 0)... };
+  (void)unused;
+  (void)include; // (unused if there are no filters)
+  (void)exclude;
+  (void)i_group;
+  (void)i_start;
+
+  // Use a constant count for full blocks so the loops can be unrolled
+  return (i_count == c_filterBlockWords) ? IntersectBits64<1 + Counts::c_includeCount, Counts::c_excludeCount>(o_mask, includes, excludes, c_filterBlockWords) :
+                                           IntersectBits64<1 + Counts::c_includeCount, Counts::c_excludeCount>(o_mask, includes, excludes, i_count);
+}
+
 template <class T, class E, typename... Args>
 class IterEntityProcessF
 {
@@ -376,8 +640,10 @@ public:
   {
   protected:
 
-    uint16_t m_groupIndex = 0;
-    uint16_t m_entitySubID = 0;
+    ECSIndex m_groupIndex = 0;
+    ECSIndex m_entitySubID = 0;
+    E*       m_group = nullptr;
+    IterJoin<T, Args...> m_join; //!< The component indices of the current entity
 
   public:
 
@@ -385,15 +651,37 @@ public:
     {
       return EntityID{ (GroupID)m_groupIndex, (EntitySubID)m_entitySubID };
     }
+
+    /// \brief Get component O of the entity, without looking up the entity (O must be T or a component filter of the iterator)
+    /// \return The component accessor is returned
+    template <class O>
+    inline typename O::Component GetComponent() const { return m_join.template Get<O>((EntitySubID)m_entitySubID); }
+
+    /// \brief Get component O of the entity, if the entity has it (O must be an Optional<O> filter of the iterator)
+    /// \param o_component Returns the component accessor if the entity has the component
+    /// \return Returns true if the entity has the component
+    template <class O>
+    inline bool GetOptional(typename O::Component& o_component) const
+    {
+      static_assert(IsOptionalFilter<O, Args...>::value, "Component must be an Optional<> filter of the iterator");
+      return GetIterOptional<O>(*m_group, (EntitySubID)m_entitySubID, o_component);
+    }
   };
 
   struct Iterator : public Value
   {
-    uint16_t m_componentCount = 0;
-    uint64_t m_bits;
-    uint64_t m_testBit;
-    uint16_t m_entityCount;
-    E*       m_group = nullptr;
+    using Value::m_index;
+    using Value::m_manager;
+    using Value::m_groupIndex;
+    using Value::m_entitySubID;
+    using Value::m_group;
+    using Value::m_join;
+
+    uint64_t m_flagBits = 0;  //!< The remaining filtered bits of the current bit data item (current entity is the lowest bit)
+
+    uint64_t m_mask[c_filterBlockWords]; //!< The intersected bits of the component and all filters of a block of bit data items
+    uint32_t m_maskStart = 0;            //!< The first bit data item in the mask
+    uint32_t m_maskEnd = 0;              //!< The end bit data item in the mask (exclusive)
 
     const Context<E>& m_context;
 
@@ -403,38 +691,29 @@ public:
       UpdateGroupIndex();
     }
 
-    template<typename H>
-    inline uint64_t GetFlagBits(uint16_t i_index) const
-    {
-      return GetManager<H>(*m_group).GetBits()[i_index];
-    }
-
-    template<typename H, typename... Tail, typename = typename std::enable_if<(sizeof...(Tail)) != 0>::type>
-    inline uint64_t GetFlagBits(uint16_t i_index) const
+    /// \brief Intersect the bits of the component and all filters of a block of bit data items into the scratch mask
+    /// \return Returns true if any entity of the block matches
+    inline bool FillMask(uint32_t i_start)
     {
-      return GetFlagBits<H>(i_index) &
-             GetFlagBits<Tail...>(i_index);
+      uint32_t count = std::min(c_filterBlockWords, uint32_t(m_manager->GetBits().size()) - i_start);
+      m_maskStart = i_start;
+      m_maskEnd = i_start + count;
+      return IntersectFilterBits<Args...>(m_manager->GetBits().data() + i_start, *m_group, i_start, count, m_mask);
     }
 
     inline Iterator& operator++()
     {
-      // Go to next group if no more components
-      if (m_index == (m_componentCount - 1))
+      // Clear the current bit and jump to the next set bit, going to the next group if no more entities
+      m_flagBits &= m_flagBits - 1;
+      if (m_flagBits != 0 ||
+          FindBits(uint32_t(m_entitySubID >> 6) + 1))
       {
-        m_groupIndex++;
-        UpdateGroupIndex();
+        UpdateEntityID();
       }
       else
       {
-        uint64_t flagBits = m_bits & GetFlagBits<Args...>(m_entitySubID >> 6);
-        UpdateEntityID(flagBits);
-
-        // Go to next group if no more entities
-        if (m_entitySubID >= m_entityCount)
-        {
-          m_groupIndex++;
-          UpdateGroupIndex();
-        }
+        m_groupIndex++;
+        UpdateGroupIndex();
       }
 
       return *this;
@@ -448,95 +727,62 @@ public:
         if (m_group != nullptr)
         {
           m_manager = &::GetManager<T>(*m_group);
-
-          m_entityCount    = m_group->GetEntityCount();
-          m_componentCount = m_manager->GetComponentCount();
-
-          if (m_componentCount > 0)
+          m_join.SetGroup(*m_group);
+          m_maskStart = m_maskEnd = 0;
+          if (m_manager->GetComponentCount() > 0 &&
+              FindBits(0))
           {
-            m_entitySubID = 0;
-            m_testBit = 0x1;
-
-            // Skip starting zero areas
-            for (uint32_t i = 0; i < m_manager->GetBits().size(); i++)
-            {
-              m_bits = m_manager->GetBits()[i];
-              if (m_bits != 0)
-              {
-                uint64_t flagBits = m_bits & GetFlagBits<Args...>(i);
-                if (flagBits != 0)
-                {
-                  m_index = m_manager->GetPrevSum()[i];
-
-                  // If not the first bit, go to the next
-                  if ((flagBits & m_testBit) == 0)
-                  {
-                    UpdateEntityID(flagBits);
-                  }
-                  break;
-                }
-              }
-              m_entitySubID += 64;
-            }
-
-            // Only break if an id is set
-            if (m_entitySubID < m_entityCount)
-            {
-              break;
-            }
+            UpdateEntityID();
+            break;
           }
         }
       }
     }
 
-    inline void UpdateEntityID(uint64_t flagBits)
+    inline bool FindBits(uint32_t i_start)
     {
-      do
+      // Skip long runs of 0 bits using the summary bitmap, then scan the intersected mask a block at a time
+      // (the rest of the current block is scanned first, without a summary bitmap lookup per bit data item)
+      const std::vector<uint64_t>& bits = m_manager->GetBits();
+      uint32_t i = (i_start < m_maskEnd) ? i_start : m_manager->FindNextBits(i_start);
+      for (; i < bits.size(); i = m_manager->FindNextBits(m_maskEnd))
       {
-        // Go to next bit
-        m_index += (m_bits & m_testBit) != 0 ? 1 : 0;
-        m_testBit <<= 1;
-        m_entitySubID++;
-        if (m_entitySubID >= m_entityCount)
+        // Skip whole blocks with no entities that match all filters
+        if ((i < m_maskStart || i >= m_maskEnd) &&
+            !FillMask(i & ~(c_filterBlockWords - 1)))
         {
-          return;
+          continue;
         }
 
-        // If going to the next group of 64
-        if (m_testBit == 0)
+        for (; i < m_maskEnd; i++)
         {
-          m_testBit = 0x1;
-
-          // Skip long runs of 0 bits
-          for (uint32_t i = (m_entitySubID >> 6); i < m_manager->GetBits().size(); i++)
-          {
-            m_bits = m_manager->GetBits()[i];
-            if (m_bits != 0)
-            {
-              flagBits = m_bits & GetFlagBits<Args...>(i);
-              if (flagBits != 0)
-              {
-                m_index = m_manager->GetPrevSum()[i];
-                break;
-              }
-            }
-            m_entitySubID += 64;
-          }
-          if (m_entitySubID >= m_entityCount)
+          uint64_t flagBits = m_mask[i - m_maskStart];
+          if (flagBits != 0)
           {
-            return;
+            m_flagBits = flagBits;
+            m_entitySubID = ECSIndex(i << 6);
+            m_join.SetBitData(i);
+            return true;
           }
         }
+      }
+      return false;
+    }
 
-      } while ((flagBits & m_testBit) == 0);
+    inline void UpdateEntityID()
+    {
+      uint32_t bitIndex = CountTrailingZeros64(m_flagBits);
+      m_entitySubID = ECSIndex((m_entitySubID & ~0x3F) + bitIndex);
+      m_join.SetBit(bitIndex);
+      m_index = T::c_unordered ? m_manager->GetDataIndex((EntitySubID)m_entitySubID) : m_join.GetIndex(0);
     }
 
-    inline bool operator != (uint16_t a_other) const { return this->m_groupIndex != a_other; }
+    inline bool operator != (ECSIndex a_other) const { return this->m_groupIndex != a_other; }
     inline Value& operator *() { return *this; }
   };
 
   inline Iterator begin() { return Iterator(m_context); }
-  inline uint16_t end() { return (uint16_t)m_context.GetGroups().size(); }
+  inline ECSIndex end() { return (ECSIndex)m_context.GetGroups().size(); }
 
   const Context<E>& m_context;
 };
@@ -557,8 +803,10 @@ public:
   {
   protected:
 
-    uint16_t m_groupIndex = 0;
-    uint16_t m_entitySubID = 0;
+    ECSIndex m_groupIndex = 0;
+    ECSIndex m_entitySubID = 0;
+    E*       m_group = nullptr;
+    IterJoin<T, Args...> m_join; //!< The component indices of the current entity
 
   public:
 
@@ -566,130 +814,311 @@ public:
     {
       return EntityID{ (GroupID)m_groupIndex, (EntitySubID)m_entitySubID };
     }
+
+    /// \brief Get component O of the entity, without looking up the entity (O must be T or a component filter of the iterator)
+    /// \return The component accessor is returned
+    template <class O>
+    inline typename O::Component GetComponent() const { return m_join.template Get<O>((EntitySubID)m_entitySubID); }
+
+    /// \brief Get component O of the entity, if the entity has it (O must be an Optional<O> filter of the iterator)
+    /// \param o_component Returns the component accessor if the entity has the component
+    /// \return Returns true if the entity has the component
+    template <class O>
+    inline bool GetOptional(typename O::Component& o_component) const
+    {
+      static_assert(IsOptionalFilter<O, Args...>::value, "Component must be an Optional<> filter of the iterator");
+      return GetIterOptional<O>(*m_group, (EntitySubID)m_entitySubID, o_component);
+    }
   };
 
   struct Iterator : public Value
   {
-    uint16_t m_componentCount = 0;
-    uint64_t m_bits = 0;
-    uint64_t m_testBit = 0x1;
-    E&       m_group;
+    using Value::m_index;
+    using Value::m_manager;
+    using Value::m_groupIndex;
+    using Value::m_entitySubID;
+    using Value::m_group;
+    using Value::m_join;
+
+    ECSIndex m_componentCount = 0;
+    uint64_t m_flagBits = 0;  //!< The remaining filtered bits of the current bit data item (current entity is the lowest bit)
+
+    uint64_t m_mask[c_filterBlockWords]; //!< The intersected bits of the component and all filters of a block of bit data items
+    uint32_t m_maskStart = 0;            //!< The first bit data item in the mask
+    uint32_t m_maskEnd = 0;              //!< The end bit data item in the mask (exclusive)
 
     inline Iterator(GroupID i_groupID, E &i_group)
-    : m_group(i_group)
     {
-      m_groupIndex = (uint16_t)i_groupID;
-      m_manager = &::GetManager<T>(m_group);
+      m_groupIndex = (ECSIndex)i_groupID;
+      m_group = &i_group;
+      m_manager = &::GetManager<T>(i_group);
+      m_join.SetGroup(i_group);
       m_componentCount = m_manager->GetComponentCount();
 
-      if (m_componentCount > 0)
+      m_index = m_componentCount; // Set initial index in case no values found
+      if (m_componentCount > 0 &&
+          FindBits(0))
+      {
+        UpdateEntityID();
+      }
+    }
+
+    /// \brief Intersect the bits of the component and all filters of a block of bit data items into the scratch mask
+    /// \return Returns true if any entity of the block matches
+    inline bool FillMask(uint32_t i_start)
+    {
+      uint32_t count = std::min(c_filterBlockWords, uint32_t(m_manager->GetBits().size()) - i_start);
+      m_maskStart = i_start;
+      m_maskEnd = i_start + count;
+      return IntersectFilterBits<Args...>(m_manager->GetBits().data() + i_start, *m_group, i_start, count, m_mask);
+    }
+
+    inline Iterator& operator++()
+    {
+      // Clear the current bit and jump to the next set bit, ending if no more entities
+      m_flagBits &= m_flagBits - 1;
+      if (m_flagBits != 0 ||
+          FindBits(uint32_t(m_entitySubID >> 6) + 1))
+      {
+        UpdateEntityID();
+      }
+      else
+      {
+        m_index = m_componentCount;
+      }
+
+      return *this;
+    }
+
+    inline bool FindBits(uint32_t i_start)
+    {
+      // Skip long runs of 0 bits using the summary bitmap, then scan the intersected mask a block at a time
+      // (the rest of the current block is scanned first, without a summary bitmap lookup per bit data item)
+      const std::vector<uint64_t>& bits = m_manager->GetBits();
+      uint32_t i = (i_start < m_maskEnd) ? i_start : m_manager->FindNextBits(i_start);
+      for (; i < bits.size(); i = m_manager->FindNextBits(m_maskEnd))
       {
-        m_entitySubID = 0;
-        m_index = m_componentCount; // Set initial index in case no values found
+        // Skip whole blocks with no entities that match all filters
+        if ((i < m_maskStart || i >= m_maskEnd) &&
+            !FillMask(i & ~(c_filterBlockWords - 1)))
+        {
+          continue;
+        }
 
-        // Skip starting zero areas
-        for (uint32_t i = 0; i < m_manager->GetBits().size(); i++)
+        for (; i < m_maskEnd; i++)
         {
-          m_bits = m_manager->GetBits()[i];
-          if (m_bits != 0)
+          uint64_t flagBits = m_mask[i - m_maskStart];
+          if (flagBits != 0)
           {
-            uint64_t flagBits = m_bits & GetFlagBits<Args...>((uint16_t)i);
-            if (flagBits != 0)
-            {
-              m_index = m_manager->GetPrevSum()[i];
-
-              // If not the first bit, go to the next
-              if ((flagBits & m_testBit) == 0)
-              {
-                UpdateEntityID(flagBits);
-              }
-              break;
-            }
+            m_flagBits = flagBits;
+            m_entitySubID = ECSIndex(i << 6);
+            m_join.SetBitData(i);
+            return true;
           }
-          m_entitySubID += 64;
         }
       }
+      return false;
+    }
+
+    inline void UpdateEntityID()
+    {
+      uint32_t bitIndex = CountTrailingZeros64(m_flagBits);
+      m_entitySubID = ECSIndex((m_entitySubID & ~0x3F) + bitIndex);
+      m_join.SetBit(bitIndex);
+      m_index = T::c_unordered ? m_manager->GetDataIndex((EntitySubID)m_entitySubID) : m_join.GetIndex(0);
+    }
+
+    inline bool operator != (ECSIndex) const { return this->m_index < this->m_componentCount; }
+    inline Value& operator *() { return *this; }
+  };
+
+  inline Iterator begin() { return Iterator(m_groupID, m_group); }
+  inline ECSIndex end() { return 0; }
+
+  GroupID m_groupID;
+  E& m_group;
+};
+
+template <class T, typename... Args, template<class> class C, class E, typename = typename std::enable_if<(sizeof...(Args)) != 0>::type>
+auto IterEntity(const C<E> &i_context, GroupID i_groupID) { return IterEntityProcessGroupF<T, E, Args...>(i_groupID, *i_context.GetGroup(i_groupID)); }
+
+
+
+/// \brief Iterates each entity that has flag F and all filters Args (components/flags, Without<>, Optional<>), in all groups or one group.
+///        Flags have no summary bitmap, so the bits of the flag and filters are intersected a block of bit data items at a time
+///        and empty blocks are skipped. The cost is proportional to the entity capacity / 512 plus the count of matching entities.
+template <class F, class E, typename... Args>
+class IterFlagsProcess
+{
+public:
+
+  inline IterFlagsProcess(const Context<E> &i_context, ECSIndex i_groupStart, ECSIndex i_groupEnd)
+    : m_context(i_context), m_groupStart(i_groupStart), m_groupEnd(i_groupEnd) {}
+
+  struct Value
+  {
+  protected:
+
+    ECSIndex m_groupIndex = 0;
+    ECSIndex m_entitySubID = 0;
+    E*       m_group = nullptr;
+    IterJoin<F, Args...> m_join; //!< The component indices of the current entity
+
+  public:
+
+    inline EntityID GetEntityID() const
+    {
+      return EntityID{ (GroupID)m_groupIndex, (EntitySubID)m_entitySubID };
     }
 
-    template<typename H>
-    inline uint64_t GetFlagBits(uint16_t i_index) const
+    /// \brief Get component O of the entity, without looking up the entity (O must be a component filter of the iterator)
+    /// \return The component accessor is returned
+    template <class O>
+    inline typename O::Component GetComponent() const { return m_join.template Get<O>((EntitySubID)m_entitySubID); }
+
+    /// \brief Get component O of the entity, if the entity has it (O must be an Optional<O> filter of the iterator)
+    /// \param o_component Returns the component accessor if the entity has the component
+    /// \return Returns true if the entity has the component
+    template <class O>
+    inline bool GetOptional(typename O::Component& o_component) const
     {
-      return GetManager<H>(m_group).GetBits()[i_index];
+      static_assert(IsOptionalFilter<O, Args...>::value, "Component must be an Optional<> filter of the iterator");
+      return GetIterOptional<O>(*m_group, (EntitySubID)m_entitySubID, o_component);
     }
+  };
 
-    template<typename H, typename... Tail, typename = typename std::enable_if<(sizeof...(Tail)) != 0>::type>
-    inline uint64_t GetFlagBits(uint16_t i_index) const
+  struct Iterator : public Value
+  {
+    using Value::m_groupIndex;
+    using Value::m_entitySubID;
+    using Value::m_group;
+    using Value::m_join;
+
+    const F* m_flags = nullptr; //!< The flag manager of the current group
+    uint64_t m_flagBits = 0;    //!< The remaining filtered bits of the current bit data item (current entity is the lowest bit)
+    ECSIndex m_groupEnd = 0;    //!< The end group index (exclusive)
+
+    uint64_t m_mask[c_filterBlockWords]; //!< The intersected bits of the flag and all filters of a block of bit data items
+    uint32_t m_maskStart = 0;            //!< The first bit data item in the mask
+    uint32_t m_maskEnd = 0;              //!< The end bit data item in the mask (exclusive)
+
+    const Context<E>& m_context;
+
+    inline Iterator(const Context<E> &i_context, ECSIndex i_groupStart, ECSIndex i_groupEnd)
+      : m_groupEnd(i_groupEnd), m_context(i_context)
     {
-      return GetFlagBits<H>(i_index) &
-             GetFlagBits<Tail...>(i_index);
+      m_groupIndex = i_groupStart;
+      UpdateGroupIndex();
+    }
+
+    /// \brief Intersect the bits of the flag and all filters of a block of bit data items into the scratch mask
+    /// \return Returns true if any entity of the block matches
+    inline bool FillMask(uint32_t i_start)
+    {
+      uint32_t count = std::min(c_filterBlockWords, uint32_t(m_flags->GetBits().size()) - i_start);
+      m_maskStart = i_start;
+      m_maskEnd = i_start + count;
+      return IntersectFilterBits<Args...>(m_flags->GetBits().data() + i_start, *m_group, i_start, count, m_mask);
     }
 
     inline Iterator& operator++()
     {
-      if (m_index < m_componentCount)
+      // Clear the current bit and jump to the next set bit, going to the next group if no more entities
+      m_flagBits &= m_flagBits - 1;
+      if (m_flagBits != 0 ||
+          FindBits(uint32_t(m_entitySubID >> 6) + 1))
+      {
+        UpdateEntityID();
+      }
+      else
       {
-        uint64_t flagBits = m_bits & GetFlagBits<Args...>(m_entitySubID >> 6);
-        UpdateEntityID(flagBits);
+        m_groupIndex++;
+        UpdateGroupIndex();
       }
 
       return *this;
     }
 
-    inline void UpdateEntityID(uint64_t flagBits)
+    inline void UpdateGroupIndex()
     {
-      do
+      for (; m_groupIndex < m_groupEnd; m_groupIndex++)
       {
-        // Go to next bit
-        m_index += (m_bits & m_testBit) != 0 ? 1 : 0;
-        m_testBit <<= 1;
-        m_entitySubID++;
-        if (m_index >= m_componentCount)
+        m_group = m_context.GetGroups()[m_groupIndex];
+        if (m_group != nullptr)
         {
-          return;
+          m_flags = &::GetManager<F>(*m_group);
+          m_join.SetGroup(*m_group);
+          m_maskStart = m_maskEnd = 0;
+          if (FindBits(0))
+          {
+            UpdateEntityID();
+            break;
+          }
         }
+      }
+    }
 
-        // If going to the next group of 64
-        if (m_testBit == 0)
+    inline bool FindBits(uint32_t i_start)
+    {
+      // Scan the intersected mask a block at a time, skipping whole blocks with no entities that match
+      uint32_t size = (uint32_t)m_flags->GetBits().size();
+      for (uint32_t i = i_start; i < size; i = m_maskEnd)
+      {
+        if ((i < m_maskStart || i >= m_maskEnd) &&
+            !FillMask(i & ~(c_filterBlockWords - 1)))
         {
-          m_testBit = 0x1;
+          continue;
+        }
 
-          // Skip long runs of 0 bits
-          m_index = m_componentCount;
-          for (uint32_t i = (m_entitySubID >> 6); i < m_manager->GetBits().size(); i++)
-          {
-            m_bits = m_manager->GetBits()[i];
-            if (m_bits != 0)
-            {
-              flagBits = m_bits & GetFlagBits<Args...>((uint16_t)i);
-              if (flagBits != 0)
-              {
-                m_index = m_manager->GetPrevSum()[i];
-                break;
-              }
-            }
-            m_entitySubID += 64;
-          }
-          if (m_index >= m_componentCount)
+        for (; i < m_maskEnd; i++)
+        {
+          uint64_t flagBits = m_mask[i - m_maskStart];
+          if (flagBits != 0)
           {
-            return;
+            m_flagBits = flagBits;
+            m_entitySubID = ECSIndex(i << 6);
+            m_join.SetBitData(i);
+            return true;
           }
         }
+      }
+      return false;
+    }
 
-      } while ((flagBits & m_testBit) == 0);
+    inline void UpdateEntityID()
+    {
+      uint32_t bitIndex = CountTrailingZeros64(m_flagBits);
+      m_entitySubID = ECSIndex((m_entitySubID & ~0x3F) + bitIndex);
+      m_join.SetBit(bitIndex);
     }
 
-    inline bool operator != (uint16_t) const { return this->m_index < this->m_componentCount; }
+    inline bool operator != (ECSIndex a_other) const { return this->m_groupIndex != a_other; }
     inline Value& operator *() { return *this; }
   };
 
-  inline Iterator begin() { return Iterator(m_groupID, m_group); }
-  inline uint16_t end() { return 0; }
+  inline Iterator begin() { return Iterator(m_context, m_groupStart, m_groupEnd); }
+  inline ECSIndex end() { return m_groupEnd; }
 
-  GroupID m_groupID;
-  E& m_group;
+  const Context<E>& m_context;
+  ECSIndex m_groupStart;
+  ECSIndex m_groupEnd;
 };
 
-template <class T, typename... Args, template<class> class C, class E, typename = typename std::enable_if<(sizeof...(Args)) != 0>::type>
-auto IterEntity(const C<E> &i_context, GroupID i_groupID) { return IterEntityProcessGroupF<T, E, Args...>(i_groupID, *i_context.GetGroup(i_groupID)); }
-
+/// \brief Iterate each entity that has flag F (and all filters Args) in all groups.
+///  Example usage:
+///         for (auto& i : IterFlags<DirtyFlags>(context))
+///         { i.GetEntityID() // Entity has the dirty flag set
+///
+///         for (auto& i : IterFlags<VisibleFlags, WorldTransforms, Without<HiddenFlags>>(context))
+///         { i.GetComponent<WorldTransforms>() // Access the component of the visible entity
+///
+template <class F, typename... Args, template<class> class C, class E>
+auto IterFlags(const C<E> &i_context) { return IterFlagsProcess<F, E, Args...>(i_context, 0, (ECSIndex)i_context.GetGroups().size()); }
 
+/// \brief Iterate each entity of a group that has flag F (and all filters Args)
+template <class F, typename... Args, template<class> class C, class E>
+auto IterFlags(const C<E> &i_context, GroupID i_groupID)
+{
+  AT_ASSERT(i_context.GetGroup(i_groupID) != nullptr);
+  return IterFlagsProcess<F, E, Args...>(i_context, (ECSIndex)i_groupID, (ECSIndex)i_groupID + 1);
+}
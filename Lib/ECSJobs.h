@@ -0,0 +1,306 @@
+#pragma once
+#include "Common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+/// \brief Counts the outstanding jobs of a batch. Jobs added with a counter increment it, and decrement it when complete.
+///        Used to wait for a batch (JobSystem::Wait) and to start continuations when a batch completes (JobSystem::AddAfter).
+///        NOTE: Must outlive all jobs and continuations that use it.
+class JobCounter
+{
+public:
+
+  inline JobCounter() {}
+
+  JobCounter(const JobCounter&) = delete;
+  JobCounter& operator=(const JobCounter&) = delete;
+
+  /// \brief Get if all jobs using the counter are complete
+  inline bool IsDone() const { return m_count == 0; }
+
+private:
+  friend class JobSystem;
+
+  struct Job
+  {
+    std::function<void()> m_func;      //!< The job function
+    JobCounter* m_counter = nullptr;   //!< The counter to decrement when the job completes (optional)
+  };
+
+  std::atomic<uint32_t> m_count { 0 }; //!< The count of outstanding jobs
+  std::mutex m_mutex;                  //!< Guards the continuations and the transition to zero
+  std::vector<Job> m_continuations;    //!< Jobs to add when the count reaches zero
+};
+
+/// \brief A work stealing job system. Each thread has its own job deque - jobs are added to and taken from the back of the
+///        current thread's deque (so nested jobs run depth first, while their data is still in the cache), and idle threads
+///        steal from the front of other threads' deques (taking the largest, oldest work first).
+///        Threads waiting on a counter run jobs until the counter completes, so jobs can add and wait on jobs (fork/join).
+///
+///  Example usage:
+///         JobSystem jobs;
+///         JobCounter counter;
+///         jobs.Add([]() { UpdateAnimation(); }, &counter);
+///         jobs.Add([]() { UpdateParticles(); }, &counter);
+///
+///         JobCounter cullCounter;
+///         jobs.AddAfter(counter, []() { Cull(); }, &cullCounter); // Continuation, runs when both jobs are complete
+///         jobs.Wait(cullCounter);
+///
+///         jobs.ParallelFor(10000, 256, [](uint32_t i_begin, uint32_t i_end) { /* Process items in [i_begin, i_end) */ });
+///
+class JobSystem
+{
+public:
+
+  /// \brief Constructor
+  /// \param i_threadCount The count of threads that run jobs (including threads that wait). Defaults to the hardware thread count.
+  explicit inline JobSystem(uint32_t i_threadCount = std::thread::hardware_concurrency())
+  {
+    i_threadCount = (i_threadCount > 0) ? i_threadCount : 1;
+    for (uint32_t i = 0; i < i_threadCount; i++)
+    {
+      m_queues.emplace_back(new Queue());
+    }
+
+    // Queue 0 is used by all threads outside the job system
+    for (uint32_t i = 1; i < i_threadCount; i++)
+    {
+      m_threads.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+  }
+
+  inline ~JobSystem()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_sleepMutex);
+      m_exit = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_threads)
+    {
+      t.join();
+    }
+  }
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  /// \brief Get the count of threads that run jobs (including the thread that waits)
+  inline uint32_t GetThreadCount() const { return (uint32_t)m_queues.size(); }
+
+  /// \brief Add a job
+  /// \param i_func The job function
+  /// \param io_counter [Optional] The counter to add the job to
+  template<typename F>
+  inline void Add(F&& i_func, JobCounter* io_counter = nullptr)
+  {
+    if (io_counter != nullptr)
+    {
+      io_counter->m_count++;
+    }
+    Push(JobCounter::Job{ std::forward<F>(i_func), io_counter });
+  }
+
+  /// \brief Add a job that starts when all jobs of a counter are complete (a continuation).
+  ///        If the counter is already complete, the job is added immediately.
+  /// \param io_dependency The counter to wait for (must not be io_counter)
+  /// \param i_func The job function
+  /// \param io_counter [Optional] The counter to add the job to (it is counted from now, so waiting on it also waits for the dependency)
+  template<typename F>
+  inline void AddAfter(JobCounter& io_dependency, F&& i_func, JobCounter* io_counter = nullptr)
+  {
+    AT_ASSERT(&io_dependency != io_counter);
+    if (io_counter != nullptr)
+    {
+      io_counter->m_count++;
+    }
+
+    JobCounter::Job job{ std::forward<F>(i_func), io_counter };
+    {
+      std::lock_guard<std::mutex> lock(io_dependency.m_mutex);
+      if (io_dependency.m_count != 0)
+      {
+        io_dependency.m_continuations.push_back(std::move(job));
+        return;
+      }
+    }
+    Push(std::move(job));
+  }
+
+  /// \brief Wait for all jobs of a counter to complete, running jobs on this thread while waiting
+  /// \param io_counter The counter to wait for
+  inline void Wait(JobCounter& io_counter)
+  {
+    uint32_t queueIndex = GetQueueIndex();
+    while (io_counter.m_count != 0)
+    {
+      if (!RunJob(queueIndex))
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    // Ensure the thread that completed the counter has released it
+    std::lock_guard<std::mutex> lock(io_counter.m_mutex);
+  }
+
+  /// \brief Call a function on ranges of [0, i_count) in parallel, returning when all ranges are complete (fork/join)
+  /// \param i_count The count of items
+  /// \param i_grainSize The count of items per job
+  /// \param i_func The function called with the range of each job, as i_func(begin, end)
+  template<typename F>
+  inline void ParallelFor(uint32_t i_count, uint32_t i_grainSize, const F& i_func)
+  {
+    AT_ASSERT(i_grainSize > 0);
+    JobCounter counter;
+    for (uint32_t begin = 0; begin < i_count; begin += i_grainSize)
+    {
+      uint32_t end = (i_count - begin > i_grainSize) ? begin + i_grainSize : i_count;
+      Add([&i_func, begin, end]() { i_func(begin, end); }, &counter);
+    }
+    Wait(counter);
+  }
+
+  /// \brief Call i_func(taskIndex) for each task index in [0, i_taskCount) in parallel, returning when all are complete.
+  ///        (The same interface as TaskPool::Run, so the job system can be passed to ParallelForEach)
+  /// \param i_taskCount The count of tasks
+  /// \param i_func The function to call for each task
+  template<typename F>
+  inline void Run(uint32_t i_taskCount, const F& i_func)
+  {
+    ParallelFor(i_taskCount, 1, [&i_func](uint32_t i_begin, uint32_t) { i_func(i_begin); });
+  }
+
+private:
+
+  struct Queue
+  {
+    std::mutex m_mutex;                   //!< Guards the jobs
+    std::deque<JobCounter::Job> m_jobs;   //!< The jobs - the owner uses the back, thieves the front
+  };
+
+  std::vector<std::unique_ptr<Queue>> m_queues; //!< The job queue of each thread
+  std::vector<std::thread> m_threads;           //!< The worker threads
+
+  std::atomic<uint32_t> m_pendingJobs { 0 };    //!< The count of jobs in all queues
+  std::mutex m_sleepMutex;                      //!< Guards sleeping and exit
+  std::condition_variable m_wake;               //!< Signaled when jobs are added or on exit
+  bool m_exit = false;                          //!< Set to stop the workers
+
+  /// \brief Get the queue of the current thread (0 for threads outside the job system)
+  inline uint32_t GetQueueIndex(uint32_t i_setIndex = 0, bool i_set = false)
+  {
+    static thread_local const JobSystem* s_system = nullptr;
+    static thread_local uint32_t s_index = 0;
+    if (i_set)
+    {
+      s_system = this;
+      s_index = i_setIndex;
+    }
+    return (s_system == this) ? s_index : 0;
+  }
+
+  inline void Push(JobCounter::Job&& i_job)
+  {
+    // Count the job before it is visible, so a thief can not decrement the count below zero
+    m_pendingJobs++;
+    Queue& queue = *m_queues[GetQueueIndex()];
+    {
+      std::lock_guard<std::mutex> lock(queue.m_mutex);
+      queue.m_jobs.push_back(std::move(i_job));
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+  }
+
+  /// \brief Run one job, from the back of the passed queue or stolen from the front of another queue
+  /// \return Returns true if a job was run
+  inline bool RunJob(uint32_t i_queueIndex)
+  {
+    JobCounter::Job job;
+    bool found = false;
+    uint32_t queueCount = (uint32_t)m_queues.size();
+    for (uint32_t i = 0; i < queueCount && !found; i++)
+    {
+      Queue& queue = *m_queues[(i_queueIndex + i) % queueCount];
+      std::lock_guard<std::mutex> lock(queue.m_mutex);
+      if (!queue.m_jobs.empty())
+      {
+        if (i == 0)
+        {
+          job = std::move(queue.m_jobs.back());
+          queue.m_jobs.pop_back();
+        }
+        else
+        {
+          job = std::move(queue.m_jobs.front());
+          queue.m_jobs.pop_front();
+        }
+        found = true;
+      }
+    }
+
+    if (!found)
+    {
+      return false;
+    }
+    m_pendingJobs--;
+
+    job.m_func();
+    if (job.m_counter != nullptr)
+    {
+      Complete(*job.m_counter);
+    }
+    return true;
+  }
+
+  /// \brief Decrement the counter of a completed job, adding the continuations if it was the last job
+  inline void Complete(JobCounter& io_counter)
+  {
+    std::vector<JobCounter::Job> continuations;
+    {
+      std::lock_guard<std::mutex> lock(io_counter.m_mutex);
+      if (--io_counter.m_count == 0)
+      {
+        continuations.swap(io_counter.m_continuations);
+      }
+    }
+
+    for (JobCounter::Job& job : continuations)
+    {
+      Push(std::move(job));
+    }
+  }
+
+  inline void WorkerLoop(uint32_t i_queueIndex)
+  {
+    GetQueueIndex(i_queueIndex, true);
+    for (;;)
+    {
+      if (RunJob(i_queueIndex))
+      {
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(m_sleepMutex);
+      m_wake.wait(lock, [this]() { return m_exit || m_pendingJobs != 0; });
+      if (m_exit)
+      {
+        return;
+      }
+    }
+  }
+};
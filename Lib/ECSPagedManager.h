@@ -0,0 +1,179 @@
+#pragma once
+#include "ECS.h"
+
+#include <algorithm>
+#include <memory>
+
+/// \brief Template implementation of a ComponentManager that stores components in pages, one page per 64 entity bit data item.
+///  Adding or removing a component only moves the components in the same page, and pages are never re-allocated.
+///  Useful for large groups where ComponentTypeManager would move the whole array on each add/remove.
+///
+///  Component accessors cache the page they last accessed, so Iter<A> and IterEntity<A> access is sequential per page.
+///  Random access by component index (eg. GetComponent) does a binary search for the page.
+///
+///  Example usage:
+///         struct A { /*Data members */ };
+///         class AManager : public ComponentTypePagedManager<A> {};
+///
+///         // Access the components of each page directly
+///         for (uint32_t p = 0; p < manager.GetPageCount(); p++)
+///         {
+///           A* data = manager.GetPageData(p);
+///           for (ECSIndex i = 0; i < manager.GetPageComponentCount(p); i++) { data[i] = foo; }
+///         }
+///
+template<typename T>
+class ComponentTypePagedManager : public ComponentManager
+{
+public:
+
+  typedef T DataType; //!< The data type passed when adding components (eg. with a CommandBuffer)
+  static const uint32_t c_pageSize = 64; //!< The count of components in a page (one per entity in a bit data item)
+
+  /// \brief The cached page of a component accessor
+  struct PageCache
+  {
+    const ComponentTypePagedManager* m_manager = nullptr; //!< The manager the page was found in
+    ECSIndex m_start = 0;                                 //!< The component index of the first component in the page
+    ECSIndex m_count = 0;                                 //!< The count of components in the page
+    T* m_data = nullptr;                                  //!< The page data
+  };
+
+  /// \brief The component accessor
+  class Component : public ComponentBase<ComponentTypePagedManager<T>>
+  {
+  public:
+    inline T* operator->() const { return &GetData(); }
+    inline T& operator* () const { return GetData(); }
+    inline T& GetData() const { return this->m_manager->GetData(this->m_index, m_cache); }
+
+  private:
+    mutable PageCache m_cache; //!< The last accessed page
+  };
+
+  /// \brief Get the component data at the passed index, updating the page cache if the index is not in the cached page
+  /// \param i_index The component index
+  /// \param io_cache The page cache to use and update
+  /// \return The component data is returned
+  inline T& GetData(ECSIndex i_index, PageCache& io_cache) const
+  {
+    if (io_cache.m_manager != this ||
+        ECSIndex(i_index - io_cache.m_start) >= io_cache.m_count)
+    {
+      uint32_t page = FindBitDataIndex(i_index);
+      io_cache.m_manager = this;
+      io_cache.m_start = GetPrevSum(page);
+      io_cache.m_count = GetPageComponentCount(page);
+      io_cache.m_data = m_pages[page]->m_data;
+    }
+    return io_cache.m_data[i_index - io_cache.m_start];
+  }
+
+  /// \brief Get the count of pages (some pages may be empty)
+  inline uint32_t GetPageCount() const { return (uint32_t)std::min(m_pages.size(), GetBits().size()); }
+
+  /// \brief Get the count of components stored in the page
+  inline ECSIndex GetPageComponentCount(uint32_t i_page) const { return PopCount64(GetBits()[i_page]); }
+
+  /// \brief Get the contiguous component data of the page, or nullptr if the page has never been used
+  inline T* GetPageData(uint32_t i_page) const { return m_pages[i_page] ? m_pages[i_page]->m_data : nullptr; }
+
+  inline void OnComponentAdd(EntityID i_entity, ECSIndex i_index)
+  {
+    InsertSlot(i_entity.m_subID, i_index) = T();
+  }
+
+  inline void OnComponentAdd(EntityID i_entity, ECSIndex i_index, const T& i_addData)
+  {
+    InsertSlot(i_entity.m_subID, i_index) = i_addData;
+  }
+
+  inline void OnComponentsAdd(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count)
+  {
+    // Indices are the final sorted indices, so inserting in ascending order places each value correctly
+    for (ECSIndex i = 0; i < i_count; i++)
+    {
+      InsertSlot(i_entities[i].m_subID, i_indices[i]) = T();
+    }
+  }
+
+  inline void OnComponentsAdd(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count, const T* i_addData)
+  {
+    for (ECSIndex i = 0; i < i_count; i++)
+    {
+      InsertSlot(i_entities[i].m_subID, i_indices[i]) = i_addData[i];
+    }
+  }
+
+  void OnComponentRemove(EntityID i_entity, ECSIndex i_index) override
+  {
+    // The prefix sum of the page is not changed by removing a component in the page
+    uint32_t page = (ECSIndex)i_entity.m_subID >> 6;
+    RemoveSlot(page, i_index - GetPrevSum(page));
+  }
+
+  void OnComponentsRemove(const EntityID* i_entities, const ECSIndex* i_indices, ECSIndex i_count) override
+  {
+    // Prefix sums have already been updated for the whole batch, so add back the count removed from previous pages
+    for (ECSIndex i = 0; i < i_count;)
+    {
+      uint32_t page = (ECSIndex)i_entities[i].m_subID >> 6;
+      ECSIndex end = i + 1;
+      while (end < i_count && ((ECSIndex)i_entities[end].m_subID >> 6) == page)
+      {
+        end++;
+      }
+
+      // Remove in reverse order so the remaining slots stay valid
+      ECSIndex pageStart = GetPrevSum(page) + i;
+      for (ECSIndex r = end; r > i; r--)
+      {
+        RemoveSlot(page, i_indices[r - 1] - pageStart);
+      }
+      i = end;
+    }
+  }
+
+  inline void ReserveComponent(ECSIndex i_count)
+  {
+    m_pages.reserve((i_count + c_pageSize - 1) / c_pageSize);
+  }
+
+private:
+
+  struct Page
+  {
+    T m_data[c_pageSize]; //!< The components of the page, sorted by entity
+  };
+
+  std::vector<std::unique_ptr<Page>> m_pages; //!< The pages, allocated on first use
+
+  /// \brief Make room in the page of the entity for the component with the passed index
+  inline T& InsertSlot(EntitySubID i_entitySubID, ECSIndex i_index)
+  {
+    uint32_t page = (ECSIndex)i_entitySubID >> 6;
+    if (page >= m_pages.size())
+    {
+      m_pages.resize(page + 1);
+    }
+    if (!m_pages[page])
+    {
+      m_pages[page].reset(new Page());
+    }
+
+    // Move up the components after the slot (at most one page)
+    T* data = m_pages[page]->m_data;
+    ECSIndex slot = i_index - GetPrevSum(page);
+    AT_ASSERT(slot < c_pageSize);
+    std::move_backward(data + slot, data + c_pageSize - 1, data + c_pageSize);
+    return data[slot];
+  }
+
+  /// \brief Remove the component at the slot in the page
+  inline void RemoveSlot(uint32_t i_page, ECSIndex i_slot)
+  {
+    AT_ASSERT(i_slot < c_pageSize);
+    T* data = m_pages[i_page]->m_data;
+    std::move(data + i_slot + 1, data + c_pageSize, data + i_slot);
+  }
+};
@@ -0,0 +1,280 @@
+#pragma once
+#include "ECS.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// \brief A fixed pool of worker threads that runs a batch of tasks in parallel. The calling thread also runs tasks.
+///        NOTE: Run() calls are serialized - tasks must not call Run() on the same pool.
+class TaskPool
+{
+public:
+
+  /// \brief Constructor
+  /// \param i_threadCount The count of threads that run tasks (including the calling thread). Defaults to the hardware thread count.
+  explicit inline TaskPool(uint32_t i_threadCount = std::thread::hardware_concurrency())
+  {
+    for (uint32_t i = 1; i < i_threadCount; i++)
+    {
+      m_workers.emplace_back([this]() { WorkerLoop(); });
+    }
+  }
+
+  inline ~TaskPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_exit = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_workers)
+    {
+      t.join();
+    }
+  }
+
+  TaskPool(const TaskPool&) = delete;
+  TaskPool& operator=(const TaskPool&) = delete;
+
+  /// \brief Get the count of threads that run tasks (including the calling thread)
+  inline uint32_t GetThreadCount() const { return (uint32_t)m_workers.size() + 1; }
+
+  /// \brief Run i_func(taskIndex) for each task index in [0, i_taskCount) across all threads, returning when all tasks are complete
+  /// \param i_taskCount The count of tasks
+  /// \param i_func The function to call for each task
+  template<typename F>
+  inline void Run(uint32_t i_taskCount, const F& i_func)
+  {
+    std::lock_guard<std::mutex> runLock(m_runMutex);
+    if (i_taskCount == 0)
+    {
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_taskData = &i_func;
+      m_taskInvoke = [](const void* i_data, uint32_t i_index) { (*static_cast<const F*>(i_data))(i_index); };
+      m_taskCount = i_taskCount;
+      m_nextTask = 0;
+      m_generation++;
+    }
+    m_wake.notify_all();
+
+    RunTasks();
+
+    // Wait for the workers still running tasks of this batch
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_busyWorkers == 0; });
+    m_taskData = nullptr;
+  }
+
+  /// \brief Get the default pool, shared by all parallel iteration that does not pass a pool
+  static inline TaskPool& GetDefault()
+  {
+    static TaskPool s_pool;
+    return s_pool;
+  }
+
+private:
+
+  std::vector<std::thread> m_workers;           //!< The worker threads
+  std::mutex m_runMutex;                        //!< Serializes calls to Run
+  std::mutex m_mutex;                           //!< Guards the batch state below
+  std::condition_variable m_wake;               //!< Signaled when a new batch starts or on exit
+  std::condition_variable m_done;               //!< Signaled when a worker finishes its part of a batch
+
+  const void* m_taskData = nullptr;                   //!< The function of the current batch
+  void (*m_taskInvoke)(const void*, uint32_t) = nullptr; //!< Calls the function of the current batch
+  uint32_t m_taskCount = 0;                           //!< The count of tasks in the current batch
+  std::atomic<uint32_t> m_nextTask { 0 };             //!< The next task index to run
+  uint64_t m_generation = 0;                          //!< Incremented for each batch
+  uint32_t m_busyWorkers = 0;                         //!< The count of workers running tasks of the current batch
+  bool m_exit = false;                                //!< Set to stop the workers
+
+  inline void RunTasks()
+  {
+    for (uint32_t i = m_nextTask++; i < m_taskCount; i = m_nextTask++)
+    {
+      m_taskInvoke(m_taskData, i);
+    }
+  }
+
+  inline void WorkerLoop()
+  {
+    uint64_t generation = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+      m_wake.wait(lock, [this, generation]() { return m_exit || m_generation != generation; });
+      if (m_exit)
+      {
+        return;
+      }
+      generation = m_generation;
+
+      // Only join the batch if there are tasks left to take
+      if (m_taskData == nullptr || m_nextTask >= m_taskCount)
+      {
+        continue;
+      }
+
+      m_busyWorkers++;
+      lock.unlock();
+      RunTasks();
+      lock.lock();
+      m_busyWorkers--;
+      if (m_busyWorkers == 0)
+      {
+        m_done.notify_all();
+      }
+    }
+  }
+};
+
+/// \brief The value passed to the function of ParallelForEach - the component accessor and the entity
+template <class T>
+struct ParallelValue : public T::Component
+{
+  inline EntityID GetEntityID() const
+  {
+    return EntityID{ (GroupID)m_groupIndex, (EntitySubID)m_entitySubID };
+  }
+
+  ECSIndex m_groupIndex = 0;
+  ECSIndex m_entitySubID = 0;
+};
+
+/// \brief The range of bit data items of a group processed by one task of ParallelForEach
+template <class E>
+struct ParallelChunk
+{
+  E* m_group = nullptr;     //!< The group
+  ECSIndex m_groupIndex = 0; //!< The group index
+  uint32_t m_start = 0;     //!< The first bit data item
+  uint32_t m_end = 0;       //!< The end bit data item (exclusive)
+};
+
+static const uint32_t c_parallelChunkWords = 16; //!< The count of bit data items (64 entities each) per ParallelForEach task
+
+template<typename E>
+inline uint64_t GetParallelFlagBits(E&, uint32_t) { return ~uint64_t(0); }
+
+template<typename E, typename H, typename... Tail>
+inline uint64_t GetParallelFlagBits(E& i_group, uint32_t i_index)
+{
+  return GetManager<H>(i_group).GetBits()[i_index] & GetParallelFlagBits<E, Tail...>(i_group, i_index);
+}
+
+/// \brief Add the chunks of a group that have any components
+template <class T, class E>
+inline void AddParallelChunks(E* i_group, ECSIndex i_groupIndex, std::vector<ParallelChunk<E>>& o_chunks)
+{
+  const T& manager = GetManager<T>(*i_group);
+  if (manager.GetComponentCount() == 0)
+  {
+    return;
+  }
+
+  uint32_t size = (uint32_t)manager.GetBits().size();
+  for (uint32_t start = 0; start < size; start += c_parallelChunkWords)
+  {
+    uint32_t end = std::min(start + c_parallelChunkWords, size);
+    if (manager.FindNextBits(start) < end)
+    {
+      o_chunks.push_back(ParallelChunk<E>{ i_group, i_groupIndex, start, end });
+    }
+  }
+}
+
+/// \brief Run the function on each entity of the chunk with the component and all filters
+template <class T, class E, typename... Args, typename Func>
+inline void RunParallelChunk(const ParallelChunk<E>& i_chunk, const Func& i_func)
+{
+  T& manager = GetManager<T>(*i_chunk.m_group);
+  const std::vector<uint64_t>& bits = manager.GetBits();
+
+  ParallelValue<T> value;
+  value.m_manager = &manager;
+  value.m_groupIndex = i_chunk.m_groupIndex;
+  for (uint32_t i = i_chunk.m_start; i < i_chunk.m_end; i++)
+  {
+    uint64_t componentBits = bits[i];
+    if (componentBits == 0)
+    {
+      continue;
+    }
+
+    // The prefix sum gives the component index of the first component of each bit data item
+    ECSIndex startIndex = manager.GetPrevSum(i);
+    for (uint64_t flagBits = componentBits & GetParallelFlagBits<E, Args...>(*i_chunk.m_group, i); flagBits != 0; flagBits &= flagBits - 1)
+    {
+      uint32_t bit = CountTrailingZeros64(flagBits);
+      value.m_entitySubID = ECSIndex((i << 6) + bit);
+      value.m_index = T::c_unordered ? manager.GetDataIndex((EntitySubID)value.m_entitySubID) :
+                                       ECSIndex(startIndex + PopCount64(componentBits & ((uint64_t(1) << bit) - 1)));
+      i_func(value);
+    }
+  }
+}
+
+/// \brief Call a function on each entity that has component T (and all components/flags Args) in parallel.
+///        Work is split by group, then by ranges of bit data items within a group. Entities are visited in order within a task.
+///        The function is called as i_func(value), where value is the component accessor and has GetEntityID() (like IterEntity).
+///        NOTE: The function is called from multiple threads - it must only write to the component data of the passed entity.
+///        Components must not be added or removed while running.
+///
+///  Example usage:
+///         ParallelForEach<Transforms, Bounds>(context, [](auto& i)
+///         {
+///           i.GetPosition() += vec3(1.0f);
+///         });
+///
+/// \param io_pool The pool to run the tasks on (any type with Run(taskCount, func) - eg. TaskPool or JobSystem)
+/// \param i_context The context to iterate
+/// \param i_func The function to call for each entity
+template <class T, typename... Args, class P, class E, typename Func>
+inline void ParallelForEach(P& io_pool, const Context<E>& i_context, const Func& i_func)
+{
+  std::vector<ParallelChunk<E>> chunks;
+  for (ECSIndex g = 0; g < i_context.GetGroups().size(); g++)
+  {
+    if (i_context.GetGroups()[g] != nullptr)
+    {
+      AddParallelChunks<T>(i_context.GetGroups()[g], g, chunks);
+    }
+  }
+
+  io_pool.Run((uint32_t)chunks.size(), [&chunks, &i_func](uint32_t i_task) { RunParallelChunk<T, E, Args...>(chunks[i_task], i_func); });
+}
+
+/// \brief Call a function on each entity of a group that has component T (and all components/flags Args) in parallel.
+/// \param io_pool The pool to run the tasks on (any type with Run(taskCount, func) - eg. TaskPool or JobSystem)
+/// \param i_context The context to iterate
+/// \param i_groupID The group to iterate
+/// \param i_func The function to call for each entity
+template <class T, typename... Args, class P, class E, typename Func>
+inline void ParallelForEach(P& io_pool, const Context<E>& i_context, GroupID i_groupID, const Func& i_func)
+{
+  std::vector<ParallelChunk<E>> chunks;
+  AddParallelChunks<T>(i_context.GetGroup(i_groupID), (ECSIndex)i_groupID, chunks);
+
+  io_pool.Run((uint32_t)chunks.size(), [&chunks, &i_func](uint32_t i_task) { RunParallelChunk<T, E, Args...>(chunks[i_task], i_func); });
+}
+
+/// \brief Call a function on each entity that has component T (and all components/flags Args) in parallel, using the default task pool.
+template <class T, typename... Args, class E, typename Func>
+inline void ParallelForEach(const Context<E>& i_context, const Func& i_func)
+{
+  ParallelForEach<T, Args...>(TaskPool::GetDefault(), i_context, i_func);
+}
+
+/// \brief Call a function on each entity of a group that has component T (and all components/flags Args) in parallel, using the default task pool.
+template <class T, typename... Args, class E, typename Func>
+inline void ParallelForEach(const Context<E>& i_context, GroupID i_groupID, const Func& i_func)
+{
+  ParallelForEach<T, Args...>(TaskPool::GetDefault(), i_context, i_groupID, i_func);
+}
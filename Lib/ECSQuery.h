@@ -0,0 +1,228 @@
+#pragma once
+#include "ECS.h"
+
+/// \brief A persistent query over entities that have component T and all components/flags Args (like IterEntity<T, Args...>).
+///  The matching bit data items of each group are cached, with the component index of their first component, and are only
+///  rebuilt for groups where the structural version of any of the managers changed (see ComponentFlags::GetVersion()).
+///  Long lived queries over mostly static groups only compare versions each time they are iterated.
+///  NOTE: Like IterEntity, components must not be added/removed while iterating.
+///
+///  Example usage:
+///         Query<WorldTransforms, WorldBounds> visibleQuery; // Keep between frames
+///
+///         for (auto& i : visibleQuery.Iter(context))
+///         { *i = foo;       // Access component data like a pointer
+///           i.GetEntityID() // Entity has WorldTransforms and WorldBounds
+///
+template <class T, typename... Args>
+class Query
+{
+public:
+
+  /// \brief The cached matching bits of one bit data item
+  struct Bits
+  {
+    uint32_t m_index;          //!< The index of the bit data item
+    uint64_t m_bits;           //!< The bits of entities that match the query
+    uint64_t m_componentBits;  //!< The bits of entities that have component T
+    ECSIndex m_prevSum;        //!< The component index of the first component T of the bit data item
+  };
+
+  /// \brief The cached state of one group
+  struct GroupCache
+  {
+    const void* m_group = nullptr;                         //!< The group the cache was built for
+    uint64_t m_versions[1 + sizeof...(Args)] = {};         //!< The structural versions of the managers when the cache was built
+    std::vector<Bits> m_bits;                              //!< The bit data items with any matching entities
+  };
+
+  template <class E>
+  class Process
+  {
+  public:
+
+    inline Process(const Context<E>& i_context, const std::vector<GroupCache>& i_caches) : m_context(i_context), m_caches(i_caches) {}
+
+    struct Value : public T::Component
+    {
+    protected:
+
+      ECSIndex m_groupIndex = 0;
+      ECSIndex m_entitySubID = 0;
+
+    public:
+
+      inline EntityID GetEntityID() const
+      {
+        return EntityID{ (GroupID)m_groupIndex, (EntitySubID)m_entitySubID };
+      }
+    };
+
+    struct Iterator : public Value
+    {
+      using Value::m_index;
+      using Value::m_manager;
+      using Value::m_groupIndex;
+      using Value::m_entitySubID;
+
+      uint32_t m_bitsIndex = 0; //!< The index of the current item in the cached bits of the group
+      uint64_t m_bits = 0;      //!< The remaining bits of the current item (current entity is the lowest bit)
+
+      const Context<E>& m_context;
+      const std::vector<GroupCache>& m_caches;
+
+      inline Iterator(const Context<E>& i_context, const std::vector<GroupCache>& i_caches)
+        : m_context(i_context), m_caches(i_caches)
+      {
+        UpdateGroupIndex();
+      }
+
+      inline Iterator& operator++()
+      {
+        // Clear the current bit and jump to the next set bit, going to the next cached item or group if none left
+        m_bits &= m_bits - 1;
+        if (m_bits == 0)
+        {
+          m_bitsIndex++;
+          if (m_bitsIndex == m_caches[m_groupIndex].m_bits.size())
+          {
+            m_groupIndex++;
+            UpdateGroupIndex();
+            return *this;
+          }
+          m_bits = m_caches[m_groupIndex].m_bits[m_bitsIndex].m_bits;
+        }
+        UpdateEntityID();
+        return *this;
+      }
+
+      inline void UpdateGroupIndex()
+      {
+        for (; m_groupIndex < m_caches.size(); m_groupIndex++)
+        {
+          if (m_caches[m_groupIndex].m_bits.size() > 0)
+          {
+            m_manager = &::GetManager<T>(*m_context.GetGroups()[m_groupIndex]);
+            m_bitsIndex = 0;
+            m_bits = m_caches[m_groupIndex].m_bits[0].m_bits;
+            UpdateEntityID();
+            break;
+          }
+        }
+      }
+
+      inline void UpdateEntityID()
+      {
+        const Bits& bits = m_caches[m_groupIndex].m_bits[m_bitsIndex];
+        uint32_t bitIndex = CountTrailingZeros64(m_bits);
+        m_entitySubID = ECSIndex((bits.m_index << 6) + bitIndex);
+        m_index = T::c_unordered ? m_manager->GetDataIndex((EntitySubID)m_entitySubID) :
+                                   ECSIndex(bits.m_prevSum + PopCount64(bits.m_componentBits & ((uint64_t(1) << bitIndex) - 1)));
+      }
+
+      inline bool operator != (ECSIndex a_other) const { return this->m_groupIndex != a_other; }
+      inline Value& operator *() { return *this; }
+    };
+
+    inline Iterator begin() { return Iterator(m_context, m_caches); }
+    inline ECSIndex end() { return (ECSIndex)m_caches.size(); }
+
+    const Context<E>& m_context;
+    const std::vector<GroupCache>& m_caches;
+  };
+
+  /// \brief Update the cache of each group that changed, then iterate all matching entities
+  /// \param i_context The context to iterate (must be the same context each time)
+  /// \return The iterable range is returned
+  template <class E>
+  inline Process<E> Iter(const Context<E>& i_context)
+  {
+    Update(i_context);
+    return Process<E>(i_context, m_caches);
+  }
+
+  /// \brief Update the cache of each group where any manager has a new structural version
+  /// \param i_context The context to update from
+  template <class E>
+  inline void Update(const Context<E>& i_context)
+  {
+    const std::vector<E*>& groups = i_context.GetGroups();
+    m_caches.resize(groups.size());
+    for (uint32_t g = 0; g < groups.size(); g++)
+    {
+      GroupCache& cache = m_caches[g];
+      if (groups[g] == nullptr)
+      {
+        cache.m_group = nullptr;
+        cache.m_bits.clear();
+        continue;
+      }
+
+      uint64_t versions[1 + sizeof...(Args)] = { GetManager<T>(*groups[g]).GetVersion(), GetManager<Args>(*groups[g]).GetVersion()... };
+      if (cache.m_group != groups[g] || !std::equal(std::begin(versions), std::end(versions), std::begin(cache.m_versions)))
+      {
+        cache.m_group = groups[g];
+        std::copy(std::begin(versions), std::end(versions), std::begin(cache.m_versions));
+        Rebuild(*groups[g], cache);
+        m_rebuildCount++;
+      }
+    }
+  }
+
+  /// \brief Get the count of matching entities (updating the cache)
+  /// \param i_context The context to count in
+  /// \return The count of matching entities is returned
+  template <class E>
+  inline uint32_t GetCount(const Context<E>& i_context)
+  {
+    Update(i_context);
+    uint32_t count = 0;
+    for (const GroupCache& cache : m_caches)
+    {
+      for (const Bits& bits : cache.m_bits)
+      {
+        count += PopCount64(bits.m_bits);
+      }
+    }
+    return count;
+  }
+
+  /// \brief Get the count of times a group cache was rebuilt (for profiling)
+  inline uint32_t GetRebuildCount() const { return m_rebuildCount; }
+
+private:
+
+  std::vector<GroupCache> m_caches; //!< The cache of each group, by group index
+  uint32_t m_rebuildCount = 0;      //!< The count of group cache rebuilds
+
+  template<typename E>
+  static inline uint64_t GetFilterBits(E&, uint32_t) { return ~uint64_t(0); }
+
+  template<typename E, typename H, typename... Tail>
+  static inline uint64_t GetFilterBits(E& i_group, uint32_t i_index)
+  {
+    return GetManager<H>(i_group).GetBits()[i_index] & GetFilterBits<E, Tail...>(i_group, i_index);
+  }
+
+  template <class E>
+  static inline void Rebuild(E& i_group, GroupCache& io_cache)
+  {
+    io_cache.m_bits.clear();
+    const T& manager = GetManager<T>(i_group);
+    if (manager.GetComponentCount() == 0)
+    {
+      return;
+    }
+
+    // Skip long runs of 0 bits using the summary bitmap
+    const std::vector<uint64_t>& bits = manager.GetBits();
+    for (uint32_t i = manager.FindNextBits(0); i < bits.size(); i = manager.FindNextBits(i + 1))
+    {
+      uint64_t matchBits = bits[i] & GetFilterBits<E, Args...>(i_group, i);
+      if (matchBits != 0)
+      {
+        io_cache.m_bits.push_back(Bits{ i, matchBits, bits[i], manager.GetPrevSum(i) });
+      }
+    }
+  }
+};
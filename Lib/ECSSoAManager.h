@@ -0,0 +1,262 @@
+#pragma once
+#include "ECS.h"
+#include "ECSAligned.h"
+
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+
+/// \brief A field of a SoAComponentManager. Derive a tag type per field to access it by name and to set the default value.
+///        eg. struct Position : SoAField<vec3> {};
+///            struct Scale : SoAField<vec3> { static vec3 Default() { return vec3(1.0f); } };
+template<typename T>
+struct SoAField
+{
+  typedef T Type;                        //!< The type stored for each component
+  typedef std::vector<T> Array;          //!< The array type the field is stored in
+  static const ECSIndex c_laneWidth = 1; //!< The count of values the array is padded to a multiple of
+
+  /// \brief Get the value of a newly added component
+  static inline T Default() { return T(); }
+};
+
+/// \brief A float field stored aligned to, and padded to a multiple of, W lanes (16/32/64 bytes for 4/8/16 lanes).
+///        The padding is kept zeroed, so SIMD loops over the span of the field can read GetPaddedSize() values with no scalar remainder.
+///        eg. struct CenterX : SoALaneField<8> {};
+template<ECSIndex W>
+struct SoALaneField : SoAField<float>
+{
+  typedef std::vector<float, AlignedAllocator<float, W * sizeof(float)>> Array; //!< The aligned and padded array
+  static const ECSIndex c_laneWidth = W;                                       //!< The count of float lanes
+};
+
+/// \brief A contiguous range of the values of a field
+template<typename T>
+struct SoASpan
+{
+  T* m_data = nullptr;        //!< The first value
+  ECSIndex m_count = 0;       //!< The count of values
+  uint32_t m_paddedCount = 0; //!< The count of values that can be safely read (count rounded up to the lane width of the field)
+
+  /// \brief Get the count of values rounded up to the lane width of the field. Values in the padding are zero.
+  ///        NOTE: Do not write to the padding - it is overwritten by the next add/remove.
+  inline uint32_t GetPaddedSize() const { return m_paddedCount; }
+
+  inline T* begin() const { return m_data; }
+  inline T* end() const { return m_data + m_count; }
+  inline ECSIndex size() const { return m_count; }
+  inline T& operator[](ECSIndex i_index) const { return m_data[i_index]; }
+};
+
+/// \brief Get the index of a type in a type list
+template<typename T, typename... List>
+struct SoAFieldIndex;
+
+template<typename T, typename... Tail>
+struct SoAFieldIndex<T, T, Tail...> : std::integral_constant<size_t, 0> {};
+
+template<typename T, typename Head, typename... Tail>
+struct SoAFieldIndex<T, Head, Tail...> : std::integral_constant<size_t, 1 + SoAFieldIndex<T, Tail...>::value> {};
+
+/// \brief The component accessor of a SoAComponentManager. Derive from this to add named accessors.
+///        eg. class Component : public SoAComponent<Bounds>
+///            {
+///            public:
+///              inline vec3& GetCenter() { return Get<Center>(); }
+///            };
+template<typename M>
+class SoAComponent : public ComponentBase<M>
+{
+public:
+
+  /// \brief Get the value of the field of the component
+  template<typename F>
+  inline typename F::Type& Get() const { return this->m_manager->template GetArray<F>()[this->m_index]; }
+
+  /// \brief Get the value of the field (by field index) of the component
+  template<size_t I>
+  inline auto& Get() const { return this->m_manager->template GetArray<I>()[this->m_index]; }
+};
+
+/// \brief Template implementation of a structure of arrays ComponentManager. Each field is stored in a separate parallel array.
+///
+///  Example usage:
+///         struct Position : SoAField<vec3> {};
+///         struct Rotation : SoAField<quat> { static quat Default() { return quat(1.0f, 0.0f, 0.0f, 0.0f); } };
+///         class PoseManager : public SoAComponentManager<Position, Rotation> {};
+///
+///         // Access each component
+///         for (auto& p : Iter<PoseManager>(context)) { p.Get<Position>() += vec3(1.0f); }
+///
+///         // Access the whole array of a field
+///         for (vec3& v : manager.GetSpan<Position>()) { v += vec3(1.0f); }
+///
+template<typename... F>
+class SoAComponentManager : public ComponentManager
+{
+public:
+
+  typedef std::tuple<typename F::Array...> Arrays;
+  typedef std::tuple<typename F::Type...> Values; //!< The values of all fields of one component
+  typedef Values DataType;                        //!< The data type passed when adding components (eg. with a CommandBuffer)
+  typedef SoAComponent<SoAComponentManager<F...>> Component;
+
+  /// \brief Get the array of the passed field
+  /// \return The array is returned
+  template<typename Field>
+  inline typename Field::Array& GetArray() { return std::get<SoAFieldIndex<Field, F...>::value>(m_arrays); }
+
+  /// \brief Get the array of the passed field
+  /// \return The array is returned
+  template<typename Field>
+  inline const typename Field::Array& GetArray() const { return std::get<SoAFieldIndex<Field, F...>::value>(m_arrays); }
+
+  /// \brief Get the array of the field with the passed index
+  /// \return The array is returned
+  template<size_t I>
+  inline auto& GetArray() { return std::get<I>(m_arrays); }
+
+  /// \brief Get the array of the field with the passed index
+  /// \return The array is returned
+  template<size_t I>
+  inline const auto& GetArray() const { return std::get<I>(m_arrays); }
+
+  /// \brief Get all values of the passed field, in component order
+  /// \return The span of values is returned
+  template<typename Field>
+  inline SoASpan<typename Field::Type> GetSpan()
+  {
+    auto& array = GetArray<Field>();
+    return SoASpan<typename Field::Type>{ array.data(), (ECSIndex)array.size(), GetPaddedSize<Field>(array.size()) };
+  }
+
+  /// \brief Get all values of the passed field, in component order
+  /// \return The span of values is returned
+  template<typename Field>
+  inline SoASpan<const typename Field::Type> GetSpan() const
+  {
+    const auto& array = GetArray<Field>();
+    return SoASpan<const typename Field::Type>{ array.data(), (ECSIndex)array.size(), GetPaddedSize<Field>(array.size()) };
+  }
+
+  inline void OnComponentAdd(EntityID /*i_entity*/, ECSIndex i_index)
+  {
+    ForEachField([i_index](auto& io_array, auto i_field) { io_array.insert(io_array.begin() + i_index, decltype(i_field)::type::Default()); });
+    ClearPadding();
+  }
+
+  inline void OnComponentAdd(EntityID /*i_entity*/, ECSIndex i_index, const typename F::Type&... i_addData)
+  {
+    InsertValues(i_index, std::index_sequence_for<F...>(), i_addData...);
+    ClearPadding();
+  }
+
+  inline void OnComponentsAdd(const EntityID* /*i_entities*/, const ECSIndex* i_indices, ECSIndex i_count)
+  {
+    ForEachField([i_indices, i_count](auto& io_array, auto i_field)
+    {
+      InsertAtIndices(io_array, i_indices, i_count, [](ECSIndex) { return decltype(i_field)::type::Default(); });
+    });
+    ClearPadding();
+  }
+
+  /// \brief Batch add with one array of i_count values per field
+  inline void OnComponentsAdd(const EntityID* /*i_entities*/, const ECSIndex* i_indices, ECSIndex i_count, const typename F::Type*... i_addData)
+  {
+    InsertArrays(i_indices, i_count, std::index_sequence_for<F...>(), i_addData...);
+    ClearPadding();
+  }
+
+  /// \brief Batch add with one array of i_count values of all fields
+  inline void OnComponentsAdd(const EntityID* /*i_entities*/, const ECSIndex* i_indices, ECSIndex i_count, const Values* i_addData)
+  {
+    InsertTuples(i_indices, i_count, std::index_sequence_for<F...>(), i_addData);
+    ClearPadding();
+  }
+
+  void OnComponentRemove(EntityID /*i_entity*/, ECSIndex i_index) override
+  {
+    ForEachField([i_index](auto& io_array, auto) { io_array.erase(io_array.begin() + i_index); });
+    ClearPadding();
+  }
+
+  void OnComponentsRemove(const EntityID* /*i_entities*/, const ECSIndex* i_indices, ECSIndex i_count) override
+  {
+    ForEachField([i_indices, i_count](auto& io_array, auto) { EraseAtIndices(io_array, i_indices, i_count); });
+    ClearPadding();
+  }
+
+  inline void ReserveComponent(ECSIndex i_count)
+  {
+    ForEachField([i_count](auto& io_array, auto) { io_array.reserve(i_count); });
+    ClearPadding();
+  }
+
+private:
+
+  template<typename T>
+  struct FieldTag { typedef T type; };
+
+  Arrays m_arrays; //!< The parallel arrays of each field
+
+  template<typename Field>
+  static inline uint32_t GetPaddedSize(size_t i_size)
+  {
+    return uint32_t((i_size + Field::c_laneWidth - 1) / Field::c_laneWidth * Field::c_laneWidth);
+  }
+
+  /// \brief Zero the values between the size and the padded size of each lane field, so SIMD loops can read the padding
+  ///        (called after every insert, erase or reserve, as these can move the end of the array or re-allocate it)
+  inline void ClearPadding()
+  {
+    ForEachField([](auto& io_array, auto i_field)
+    {
+      typedef typename decltype(i_field)::type Field;
+      std::fill(io_array.data() + io_array.size(), io_array.data() + GetPaddedSize<Field>(io_array.size()), typename Field::Type());
+    });
+  }
+
+  /// \brief Call the passed function with each array and a FieldTag of its field
+  template<typename Func>
+  inline void ForEachField(Func&& i_func) { ForEachField(i_func, std::index_sequence_for<F...>()); }
+
+  template<typename Func, size_t... I>
+  inline void ForEachField(Func& i_func, std::index_sequence<I...>)
+  {
+    int unused[] = { 0, (i_func(std::get<I>(m_arrays), FieldTag<F>()), 0)... };
+    (void)unused;
+  }
+
+  template<size_t... I>
+  inline void InsertValues(ECSIndex i_index, std::index_sequence<I...>, const typename F::Type&... i_addData)
+  {
+    int unused[] = { 0, (std::get<I>(m_arrays).insert(std::get<I>(m_arrays).begin() + i_index, i_addData), 0)... };
+    (void)unused;
+  }
+
+  template<size_t... I>
+  inline void InsertArrays(const ECSIndex* i_indices, ECSIndex i_count, std::index_sequence<I...>, const typename F::Type*... i_addData)
+  {
+    int unused[] = { 0, (InsertArray(std::get<I>(m_arrays), i_indices, i_count, i_addData), 0)... };
+    (void)unused;
+  }
+
+  template<typename A, typename T>
+  static inline void InsertArray(A& io_array, const ECSIndex* i_indices, ECSIndex i_count, const T* i_addData)
+  {
+    InsertAtIndices(io_array, i_indices, i_count, [i_addData](ECSIndex i) { return i_addData[i]; });
+  }
+
+  template<size_t... I>
+  inline void InsertTuples(const ECSIndex* i_indices, ECSIndex i_count, std::index_sequence<I...>, const Values* i_addData)
+  {
+    int unused[] = { 0, (InsertTupleField<I>(i_indices, i_count, i_addData), 0)... };
+    (void)unused;
+  }
+
+  template<size_t I>
+  inline void InsertTupleField(const ECSIndex* i_indices, ECSIndex i_count, const Values* i_addData)
+  {
+    InsertAtIndices(std::get<I>(m_arrays), i_indices, i_count, [i_addData](ECSIndex i) { return std::get<I>(i_addData[i]); });
+  }
+};
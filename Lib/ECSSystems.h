@@ -0,0 +1,238 @@
+#pragma once
+#include "ECSJobs.h"
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+/// \brief The component managers (or flag managers) a system reads. Used as an access declaration of SystemScheduler::AddSystem.
+template<typename... T>
+struct Reads {};
+
+/// \brief The component managers (or flag managers) a system writes. Used as an access declaration of SystemScheduler::AddSystem.
+template<typename... T>
+struct Writes {};
+
+/// \brief Declares that a system makes structural changes (adds/removes entities, groups or components), so must run alone
+struct Structural {};
+
+/// \brief Get a unique ID for a type, used to compare access declarations
+template<typename T>
+inline const void* GetSystemAccessID()
+{
+  static const char s_id = 0;
+  return &s_id;
+}
+
+/// \brief Schedules systems to run in parallel on a JobSystem, from the component managers each system declares it reads and writes.
+///        Two systems conflict if either writes a manager the other reads or writes (or either is Structural). Conflicting
+///        systems run in the order they were added, other systems run concurrently.
+///        After each Run(), the time of each system and the critical path (the chain of dependent systems that bounds the
+///        frame time) can be queried.
+///        NOTE: Declarations are not verified - a system that accesses an undeclared manager can race with other systems.
+///
+///  Example usage:
+///         SystemScheduler scheduler;
+///         scheduler.AddSystem<Writes<Transforms>>("Animation", [&]() { /* Animate transforms */ });
+///         scheduler.AddSystem<Reads<Transforms>, Writes<WorldTransforms, WorldBounds>>("WorldData", [&]() { /* Update world data */ });
+///         scheduler.AddSystem<Reads<WorldBounds>, Writes<VisibleFlags>>("Culling", [&]() { /* Cull */ });
+///         scheduler.AddSystem<Reads<AIState>, Writes<AIState>>("AI", [&]() { /* Runs concurrently with the above */ });
+///
+///         scheduler.Run(jobs);
+///         for (uint32_t system : scheduler.GetCriticalPath()) { printf("%s %fms\n", scheduler.GetSystemName(system), scheduler.GetSystemTime(system)); }
+///
+class SystemScheduler
+{
+public:
+
+  /// \brief Add a system
+  /// \param i_name The name of the system (must outlive the scheduler)
+  /// \param i_func The system function, called as i_func()
+  /// \return The index of the system is returned
+  template<typename... Access, typename F>
+  inline uint32_t AddSystem(const char* i_name, F&& i_func)
+  {
+    System system;
+    system.m_name = i_name;
+    system.m_func = std::forward<F>(i_func);
+    int unused[] = { 0, (AddAccess(Access(), system), 0)... };
+    (void)unused;
+
+    uint32_t index = (uint32_t)m_systems.size();
+    for (uint32_t i = 0; i < index; i++)
+    {
+      if (IsConflict(m_systems[i], system))
+      {
+        system.m_dependencies.push_back(i);
+        m_systems[i].m_dependents.push_back(index);
+      }
+    }
+    m_systems.push_back(std::move(system));
+    return index;
+  }
+
+  /// \brief Run all systems, returning when all are complete
+  /// \param io_jobs The job system to run the systems on
+  inline void Run(JobSystem& io_jobs)
+  {
+    m_frameStart = Clock::now();
+    for (System& system : m_systems)
+    {
+      system.m_waitCount = (uint32_t)system.m_dependencies.size();
+    }
+
+    JobCounter counter;
+    for (uint32_t i = 0; i < m_systems.size(); i++)
+    {
+      if (m_systems[i].m_dependencies.empty())
+      {
+        io_jobs.Add([this, &io_jobs, &counter, i]() { RunSystem(io_jobs, counter, i); }, &counter);
+      }
+    }
+    io_jobs.Wait(counter);
+
+    m_frameTime = GetMS(m_frameStart, Clock::now());
+    UpdateCriticalPath();
+  }
+
+  /// \brief Get the count of systems
+  inline uint32_t GetSystemCount() const { return (uint32_t)m_systems.size(); }
+
+  /// \brief Get the name of a system
+  inline const char* GetSystemName(uint32_t i_system) const { return m_systems[i_system].m_name; }
+
+  /// \brief Get the systems that must complete before a system starts
+  inline const std::vector<uint32_t>& GetDependencies(uint32_t i_system) const { return m_systems[i_system].m_dependencies; }
+
+  /// \brief Get the time a system took in the last Run() (milliseconds)
+  inline double GetSystemTime(uint32_t i_system) const { return GetMS(m_systems[i_system].m_start, m_systems[i_system].m_end); }
+
+  /// \brief Get the time the last Run() took (milliseconds)
+  inline double GetFrameTime() const { return m_frameTime; }
+
+  /// \brief Get the critical path of the last Run() - the chain of dependent systems with the largest total time, in run order
+  inline const std::vector<uint32_t>& GetCriticalPath() const { return m_criticalPath; }
+
+  /// \brief Get the total time of the systems on the critical path of the last Run() (milliseconds)
+  inline double GetCriticalPathTime() const { return m_criticalPathTime; }
+
+private:
+
+  typedef std::chrono::steady_clock Clock;
+
+  struct System
+  {
+    const char* m_name = nullptr;          //!< The name of the system
+    std::function<void()> m_func;          //!< The system function
+    std::vector<const void*> m_reads;      //!< The IDs of the managers read
+    std::vector<const void*> m_writes;     //!< The IDs of the managers written
+    bool m_structural = false;             //!< Set if the system makes structural changes
+    std::vector<uint32_t> m_dependencies;  //!< The systems that must complete first
+    std::vector<uint32_t> m_dependents;    //!< The systems that depend on this system
+    std::atomic<uint32_t> m_waitCount { 0 }; //!< The count of dependencies not yet complete in the current Run()
+    Clock::time_point m_start;             //!< The start time in the last Run()
+    Clock::time_point m_end;               //!< The end time in the last Run()
+
+    System() {}
+    System(System&& i_other)
+      : m_name(i_other.m_name), m_func(std::move(i_other.m_func)), m_reads(std::move(i_other.m_reads)), m_writes(std::move(i_other.m_writes))
+      , m_structural(i_other.m_structural), m_dependencies(std::move(i_other.m_dependencies)), m_dependents(std::move(i_other.m_dependents)) {}
+  };
+
+  std::vector<System> m_systems;          //!< The systems, in the order added
+  Clock::time_point m_frameStart;         //!< The start time of the last Run()
+  double m_frameTime = 0.0;               //!< The time of the last Run()
+  std::vector<uint32_t> m_criticalPath;   //!< The critical path of the last Run()
+  double m_criticalPathTime = 0.0;        //!< The time of the critical path of the last Run()
+
+  static inline double GetMS(Clock::time_point i_start, Clock::time_point i_end)
+  {
+    return std::chrono::duration<double, std::milli>(i_end - i_start).count();
+  }
+
+  template<typename... T>
+  static inline void AddAccess(Reads<T...>, System& io_system)
+  {
+    int unused[] = { 0, (io_system.m_reads.push_back(GetSystemAccessID<T>()), 0)... };
+    (void)unused;
+  }
+
+  template<typename... T>
+  static inline void AddAccess(Writes<T...>, System& io_system)
+  {
+    int unused[] = { 0, (io_system.m_writes.push_back(GetSystemAccessID<T>()), 0)... };
+    (void)unused;
+  }
+
+  static inline void AddAccess(Structural, System& io_system) { io_system.m_structural = true; }
+
+  static inline bool IsAnyShared(const std::vector<const void*>& i_a, const std::vector<const void*>& i_b)
+  {
+    for (const void* a : i_a)
+    {
+      for (const void* b : i_b)
+      {
+        if (a == b)
+        {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  static inline bool IsConflict(const System& i_a, const System& i_b)
+  {
+    return i_a.m_structural || i_b.m_structural ||
+           IsAnyShared(i_a.m_writes, i_b.m_writes) || IsAnyShared(i_a.m_writes, i_b.m_reads) || IsAnyShared(i_a.m_reads, i_b.m_writes);
+  }
+
+  /// \brief Run a system, then add each dependent system whose dependencies are now all complete
+  inline void RunSystem(JobSystem& io_jobs, JobCounter& io_counter, uint32_t i_system)
+  {
+    System& system = m_systems[i_system];
+    system.m_start = Clock::now();
+    system.m_func();
+    system.m_end = Clock::now();
+
+    for (uint32_t dependent : system.m_dependents)
+    {
+      if (--m_systems[dependent].m_waitCount == 0)
+      {
+        io_jobs.Add([this, &io_jobs, &io_counter, dependent]() { RunSystem(io_jobs, io_counter, dependent); }, &io_counter);
+      }
+    }
+  }
+
+  /// \brief Find the chain of dependent systems with the largest total time. Dependencies always have a lower index.
+  inline void UpdateCriticalPath()
+  {
+    std::vector<double> pathTime(m_systems.size(), 0.0);
+    std::vector<uint32_t> pathPrev(m_systems.size(), UINT32_MAX);
+    uint32_t last = UINT32_MAX;
+    m_criticalPathTime = 0.0;
+    for (uint32_t i = 0; i < m_systems.size(); i++)
+    {
+      for (uint32_t dependency : m_systems[i].m_dependencies)
+      {
+        if (pathPrev[i] == UINT32_MAX || pathTime[dependency] > pathTime[i])
+        {
+          pathTime[i] = pathTime[dependency];
+          pathPrev[i] = dependency;
+        }
+      }
+      pathTime[i] += GetSystemTime(i);
+      if (last == UINT32_MAX || pathTime[i] > m_criticalPathTime)
+      {
+        m_criticalPathTime = pathTime[i];
+        last = i;
+      }
+    }
+
+    m_criticalPath.clear();
+    for (uint32_t i = last; i != UINT32_MAX; i = pathPrev[i])
+    {
+      m_criticalPath.insert(m_criticalPath.begin(), i);
+    }
+  }
+};
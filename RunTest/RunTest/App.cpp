@@ -35,20 +35,26 @@ bool App::init()
   m_staticGroup = m_context.AddEntityGroup();
   m_dynamicGroup = m_context.AddEntityGroup();
 
-  m_context.ReserveEntities(m_staticGroup, 10000);
+  std::vector<EntityID> staticEntities(10000);
+  m_context.AddEntities(m_staticGroup, (ECSIndex)staticEntities.size(), staticEntities.data());
+
+  // Add all components in bulk (entities in a new group are created sequentially)
+  m_context.AddComponents<WorldTransforms>(m_staticGroup, staticEntities[0].m_subID, (ECSIndex)staticEntities.size());
+  m_context.AddComponents<WorldBounds>(m_staticGroup, staticEntities[0].m_subID, (ECSIndex)staticEntities.size());
+  m_context.AddComponents<Transforms>(m_staticGroup, staticEntities[0].m_subID, (ECSIndex)staticEntities.size());
+  m_context.AddComponents<Bounds>(m_staticGroup, staticEntities[0].m_subID, (ECSIndex)staticEntities.size());
+
   for (uint32_t y = 0; y < 100; y++)
   {
     for (uint32_t x = 0; x < 100; x++)
     {
-      EntityID newEntity = m_context.AddEntity(m_staticGroup);
-      m_context.AddComponent<WorldTransforms>(newEntity);
-      m_context.AddComponent<WorldBounds>(newEntity);
+      EntityID newEntity = staticEntities[y * 100 + x];
 
-      auto newTransform = m_context.AddComponent<Transforms>(newEntity);
+      auto newTransform = m_context.GetComponent<Transforms>(newEntity);
       newTransform.GetPosition() = vec3((float)x + 0.5f, 0.5f, (float)y + 0.5f);
       newTransform.GetScale() = vec3(0.25f);
 
-      auto newBounds = m_context.AddComponent<Bounds>(newEntity);
+      auto newBounds = m_context.GetComponent<Bounds>(newEntity);
       newBounds.SetCenter(vec3(0.0f));
       newBounds.SetExtents(vec3(1.0f));
 
@@ -459,9 +465,7 @@ void App::drawFrame()
 
   for (auto& v : IterEntity<WorldTransforms, WorldBounds>(m_context, m_staticGroup))
   {
-    EntityID id = v.GetEntityID();
-
-    auto bound = m_context.GetComponent<WorldBounds>(id);
+    auto bound = v.GetComponent<WorldBounds>();
     if (testAABBFrustumPlanes(cullPlanes, bound.GetCenter(), bound.GetExtents()))
     {
       DrawBox(ApplyScale(v.GetWorldTransform(), v.GetWorldScale()));